@@ -34,8 +34,25 @@
         'src/main.cc',
         'src/JSON.cc',
         'src/queue.cc',
+        'src/pool.cc',
+        'src/abort.cc',
+        'src/query.cc',
+        'src/extract.cc',
+        'src/aggregate.cc',
+        'src/filter.cc',
+        'src/search.cc',
+        'src/serialize.cc',
+        'src/v8serialize.cc',
+        'src/stringify.cc',
+        'src/snapshot.cc',
+        'src/share.cc',
+        'src/tape.cc',
         'src/parseAsync.cc',
-        'src/toObjectAsync.cc'
+        'src/parseMany.cc',
+        'src/parseBatch.cc',
+        'src/pathAsync.cc',
+        'src/toObjectAsync.cc',
+        'src/toObjectPlan.cc'
       ],
       'include_dirs': [
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -48,7 +65,7 @@
       'xcode_settings': {
         'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',
         'CLANG_CXX_LIBRARY': 'libc++',
-        'MACOSX_DEPLOYMENT_TARGET': '13.0'
+        'MACOSX_DEPLOYMENT_TARGET': '13.3'
       },
       'msvs_settings': {
         'VCCLCompilerTool': {
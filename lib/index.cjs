@@ -1,9 +1,14 @@
 const path = require('path');
+const v8 = require('v8');
 const binary = require('@mapbox/node-pre-gyp');
 
 const binding_path = binary.find(path.resolve(path.join(__dirname, '..', 'package.json')));
 const dll = require(binding_path);
 
+// The symbols of the native helpers that are not part of the API
+const internal = dll.internal;
+delete dll.internal;
+
 dll.JSON.symbolToObject = Symbol('toObject');
 dll.JSON.symbolToObjectAsync = Symbol('toObjectAsync');
 dll.JSON.symbolType = Symbol('type');
@@ -16,30 +21,113 @@ const proxyHandler = {
       if (prop === dll.JSON.symbolType) return target.type;
       return target[prop];
     }
-    const field = target.path(`/${prop}`);
-    const type = field.type;
-    if (type === 'array' || type === 'object')
-      return field.proxify();
-    return field.get();
+    return target[internal.proxyGet](prop);
+  },
+  has(target, prop) {
+    if (typeof prop === 'symbol') return prop in target;
+    return target[internal.proxyHas](prop);
   },
   ownKeys(target) {
     return Object.keys(target.get());
   },
   getOwnPropertyDescriptor(target, prop) {
-    try {
-      target.path(`/${prop}`);
+    if (typeof prop !== 'symbol' && target[internal.proxyHas](prop)) {
       return {
         configurable: true,
         enumerable: true
       };
-    } catch {
-      return {};
     }
+    return undefined;
   }
 };
 
-dll.JSON.prototype.proxify = function proxyify() {
-  return new Proxy(this, proxyHandler);
+dll.JSON[internal.proxyHandler] = proxyHandler;
+
+// Newline-delimited JSON is split in chunks at line boundaries,
+// up to `threads` chunks are parsed concurrently and
+// the documents are yielded in their original order
+const parseManyMinChunk = 1024 * 1024;
+dll.JSON.parseManyParallel = async function* (text, opts) {
+  const input = typeof text === 'string' ? Buffer.from(text, 'utf8') : text;
+  if (!Buffer.isBuffer(input)) {
+    throw new TypeError('JSON.parseManyParallel expects a string or Buffer argument');
+  }
+  const threads = Math.max(1, (opts && opts.threads) || 4);
+  const chunkSize = Math.max(parseManyMinChunk, Math.ceil(input.length / (threads * 4)));
+
+  const pending = [];
+  let pos = 0;
+  const next = () => {
+    while (pending.length < threads && pos < input.length) {
+      let end = pos + chunkSize;
+      if (end < input.length) {
+        const eol = input.indexOf(10, end);
+        end = eol < 0 ? input.length : eol + 1;
+      } else {
+        end = input.length;
+      }
+      const chunk = dll.JSON.parseManyAsync(input.subarray(pos, end));
+      // The consumer can stop before awaiting all chunks
+      chunk.catch(() => undefined);
+      pending.push({ chunk, start: pos });
+      pos = end;
+    }
+  };
+
+  next();
+  while (pending.length > 0) {
+    const { chunk, start } = pending.shift();
+    const documents = await chunk.catch((e) => {
+      throw parseManyLine(e, input, start);
+    });
+    next();
+    yield* documents;
+  }
+};
+
+// The lines in the errors of a chunk are counted from its start,
+// the lines before it are counted only when there is an error
+function parseManyLine(e, input, start) {
+  const m = e instanceof Error && /^line (\d+): /.exec(e.message);
+  if (!m) return e;
+  let line = +m[1];
+  for (let eol = input.indexOf(10); eol >= 0 && eol < start; eol = input.indexOf(10, eol + 1)) line++;
+  e.message = `line ${line}: ${e.message.slice(m[0].length)}`;
+  return e;
+}
+
+// Arrays are converted in chunks of chunkSize elements, the next
+// chunk is converted while the consumer processes the current one
+dll.JSON.prototype.toObjectStream = async function* (opts) {
+  const chunkSize = (opts && opts.chunkSize) || 1024;
+  const cursor = this[internal.toObjectCursor]();
+  let next = this[internal.toObjectChunkAsync](cursor, chunkSize, opts);
+  while (true) {
+    const chunk = await next;
+    if (chunk.length === 0) return;
+    next = this[internal.toObjectChunkAsync](cursor, chunkSize, opts);
+    // The consumer can stop before awaiting the next chunk
+    next.catch(() => undefined);
+    yield chunk;
+  }
+};
+
+// The V8 serialization format is produced in a background thread
+// and the whole object graph is created by a single call, it is
+// not time sliced and it does not support projections
+const toObjectAsync = dll.JSON.prototype.toObjectAsync;
+const toObjectAsyncNotV8 = ['latency', 'priority', 'pick', 'omit'];
+dll.JSON.prototype.toObjectAsync = function (opts) {
+  if (opts && opts.v8) {
+    const conflict = opts.offload ? 'offload' : toObjectAsyncNotV8.find((o) => opts[o] !== undefined);
+    if (conflict) throw new TypeError(`v8 cannot be combined with ${conflict}`);
+    return this.toV8BufferAsync({ signal: opts.signal }).then((buffer) => {
+      // Aborted after the serialization has completed
+      if (opts.signal && opts.signal.aborted) throw opts.signal.reason;
+      return v8.deserialize(buffer);
+    });
+  }
+  return toObjectAsync.call(this, opts);
 };
 
 module.exports = dll;
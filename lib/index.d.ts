@@ -14,6 +14,33 @@ export type JSONProxy<T> = T extends Record<string | number, any> ? {
   [JSON.symbolType]: JSONType<T>;
 } : T;
 
+export type JSONAggregation = 'sum' | 'min' | 'max' | 'count' | 'mean';
+
+export type JSONStatistics<OPS extends JSONAggregation = JSONAggregation> = {
+  [P in OPS]: P extends 'sum' | 'count' ? number : number | null;
+};
+
+export type JSONPrimitive = string | number | boolean | null;
+
+/**
+ * A condition evaluated on each record, all operators present are combined
+ */
+export interface JSONPredicate {
+  /**
+   * RFC6901 pointer to the tested value relative to the record, the record itself when omitted
+   */
+  field?: string;
+  eq?: JSONPrimitive;
+  in?: JSONPrimitive[];
+  lt?: number | string;
+  gt?: number | string;
+  prefix?: string;
+}
+
+export type JSONElementOf<T, PATH extends string> =
+  T extends Record<string | number, any> ? RFC6901<T, PATH> extends JSON<infer U> ?
+  U extends Array<infer E> ? E : any : any : any;
+
 export type RFC6901<T extends Record<string | number, any>, PATH extends string> =
   PATH extends `/${infer PROP}/${infer SUB}` ?
   RFC6901<T[PROP], `/${SUB}`> :
@@ -34,6 +61,15 @@ export class JSON<T = any> {
    */
   type: JSONType<T>;
 
+  /**
+   * The underlying type of the JSON element as a number.
+   * 
+   * Cheaper than `.type` in hot code, `JSON.types[json.typeId] === json.type`.
+   * 
+   * @type {number}
+   */
+  typeId: number;
+
   /**
    * Parse a string and return its binary representation.
    * 
@@ -41,10 +77,16 @@ export class JSON<T = any> {
    * slower for small files but faster for larger files compared
    * to the built-in JSON parser.
    * 
+   * With `opts.only`, a first pass copies the subtrees selected by
+   * a list of JSON pointers with `*` wildcards and only these are
+   * parsed and kept in memory, the arrays are compacted.
+   * 
    * @param {string} text JSON to parse
+   * @param {object} [opts={}] Options
+   * @param {string[]} [opts.only] Keep only these subtrees
    * @returns {JSON}
    */
-  static parse<U = any>(text: string | Buffer): JSON<U>;
+  static parse<U = any>(text: string | Buffer, opts?: { only?: string[] }): JSON<U>;
 
   /**
    * Parse a string and return its binary representation.
@@ -54,10 +96,117 @@ export class JSON<T = any> {
    * small files but faster for larger files compared to the built-in
    * JSON parser.
    * 
+   * When `opts.threads` is greater than 1 and the document is a large
+   * top-level array, its elements are parsed in multiple threads and
+   * merged into a single document.
+   * 
+   * `opts.only` works as with `JSON.parse()`.
+   * 
    * @param {string} text JSON to parse
+   * @param {object} [opts={}] Options
+   * @param {string[]} [opts.only] Keep only these subtrees
+   * @param {number} [opts.threads=1] Number of threads for parsing top-level arrays
+   * @param {number} [opts.priority=0] Priority on the dedicated thread pool, higher runs first
+   * @param {AbortSignal} [opts.signal] Rejects the promise and skips the parsing if it has not started
    * @returns {Promise<JSON>}
    */
-  static parseAsync<U = any>(text: string | Buffer): Promise<JSON<U>>;
+  static parseAsync<U = any>(text: string | Buffer, opts?: { only?: string[], threads?: number, priority?: number, signal?: AbortSignal }): Promise<JSON<U>>;
+
+  /**
+   * Parse newline-delimited JSON (JSON Lines) and return an array
+   * with the binary representation of each document.
+   * 
+   * All documents are parsed in a single background job, blank
+   * lines are skipped.
+   * 
+   * @param {string} text newline-delimited JSON to parse
+   * @param {object} [opts={}] Options
+   * @param {number} [opts.priority=0] Priority on the dedicated thread pool, higher runs first
+   * @returns {Promise<JSON[]>}
+   */
+  static parseManyAsync<U = any>(text: string | Buffer, opts?: { priority?: number }): Promise<JSON<U>[]>;
+
+  /**
+   * Parse many documents in a single background job and resolve
+   * with an array of their binary representations.
+   * 
+   * A document that fails to parse does not reject the promise,
+   * its entry in the array is an `Error` instead.
+   * 
+   * @param {(string | Buffer)[]} texts documents to parse
+   * @param {object} [opts={}] Options
+   * @param {number} [opts.threads=1] Split the batch between this many background jobs, up to the number of CPU cores
+   * @param {number} [opts.priority=0] Priority on the dedicated thread pool, higher runs first
+   * @returns {Promise<(JSON | Error)[]>}
+   */
+  static parseAsyncBatch<U = any>(texts: (string | Buffer)[], opts?: { threads?: number, priority?: number }): Promise<(JSON<U> | Error)[]>;
+
+  /**
+   * Parse newline-delimited JSON (JSON Lines) in multiple threads
+   * and iterate over the documents in their original order.
+   * 
+   * The input is split in chunks at line boundaries, up to
+   * `opts.threads` chunks are parsed concurrently in the libuv
+   * thread pool - which has 4 threads unless `UV_THREADPOOL_SIZE`
+   * is set.
+   * 
+   * @param {string} text newline-delimited JSON to parse
+   * @param {object} [opts={}] Options
+   * @param {number} [opts.threads=4] Number of chunks parsed concurrently
+   * @returns {AsyncGenerator<JSON>}
+   */
+  static parseManyParallel<U = any>(text: string | Buffer, opts?: { threads?: number }): AsyncGenerator<JSON<U>, void, undefined>;
+
+  /**
+   * Serialize a JS value to JSON text, same output as the built-in
+   * `JSON.stringify()` without the `replacer` and `space` arguments.
+   * 
+   * `JSON` elements embedded in the value are serialized directly from
+   * their binary representation.
+   * 
+   * @param {any} value value to serialize
+   * @returns {string | undefined}
+   */
+  static stringify(value: any): string | undefined;
+
+  /**
+   * Serialize a JS value to JSON text, same output as the built-in
+   * `JSON.stringify()` without the `replacer` and `space` arguments.
+   * 
+   * The value is captured synchronously, the string escaping and the
+   * number formatting happen in a background thread.
+   * 
+   * @param {any} value value to serialize
+   * @returns {Promise<string | undefined>}
+   */
+  static stringifyAsync(value: any): Promise<string | undefined>;
+
+  /**
+   * Load a binary snapshot created by `.save()`.
+   * 
+   * The file is memory mapped and used directly without parsing.
+   * By default, only the header and the bounds are checked and
+   * the file must be trusted - a corrupted snapshot can crash
+   * the process. `validate` checks the whole tape, this reads
+   * the whole file.
+   * 
+   * @param {string} path file to load
+   * @param {boolean} [options.validate] validate the whole tape
+   * @returns {JSON}
+   */
+  static load<U = any>(path: string, options?: { validate?: boolean }): JSON<U>;
+
+  /**
+   * Open a document shared by `.share()`, possibly in another
+   * environment (`worker_threads`).
+   * 
+   * The returned element has its own object stores while the
+   * binary representation is shared.
+   * 
+   * @param {string} token token returned by `.share()`
+   * @returns {JSON}
+   */
+  static open<U = any>(token: string): JSON<U>;
 
   /**
    * Retrieve a subtree out of the binary JSON object.
@@ -101,6 +250,125 @@ export class JSON<T = any> {
    */
   path<PATH extends string>(rfc6901: PATH, opts?: { throwOnError?: boolean }): T extends Record<string | number, any> ? RFC6901<T, PATH> : never;
 
+  /**
+   * Retrieves a deeply nested JSON element referenced by the RFC6901 JSON pointer.
+   * 
+   * Like `.path()` but the lookup runs in a background thread, only
+   * the final element is created on the main thread.
+   * 
+   * @param {string} rfc6901 RFC6901-conformant JSON pointer
+   * @param {object} [opts={}] Options
+   * @param {boolean} [opts.throwOnError=true] Reject on error when true, resolve with undefined when false
+   * @returns {Promise<any>}
+   */
+  pathAsync<PATH extends string>(rfc6901: PATH, opts?: { throwOnError?: boolean }): Promise<T extends Record<string | number, any> ? RFC6901<T, PATH> : never>;
+
+  /**
+   * Retrieves all elements matched by a RFC6901 JSON pointer that
+   * can contain `*` wildcards matching all members of an array or
+   * an object.
+   * 
+   * The part before the first wildcard must exist, elements
+   * missing the remaining segments are skipped.
+   * 
+   * @param {string} pointer RFC6901 JSON pointer where `*` segments are wildcards
+   * @returns {JSON[]}
+   */
+  query(pointer: string): JSON[];
+
+  /**
+   * Like `.query()` but the traversal runs in a background thread,
+   * only the matched elements are created on the main thread.
+   * 
+   * @param {string} pointer RFC6901 JSON pointer where `*` segments are wildcards
+   * @returns {Promise<JSON[]>}
+   */
+  queryAsync(pointer: string): Promise<JSON[]>;
+
+  /**
+   * Returns the elements of the array referenced by a RFC6901 JSON
+   * pointer that satisfy a predicate.
+   * 
+   * The predicate is evaluated on the binary representation, only
+   * the matching elements are returned to JS - as `JSON` elements
+   * or as JS objects when `opts.toObject` is set.
+   * 
+   * Multiple operators in the same predicate and multiple predicates
+   * in an array are combined.
+   * 
+   * @param {string} pointer RFC6901-conformant JSON pointer to an array
+   * @param {JSONPredicate | JSONPredicate[]} predicate Predicate
+   * @param {object} [opts={}] Options
+   * @param {boolean} [opts.toObject=false] Return JS objects instead of `JSON` elements
+   * @returns {JSON[] | any[]}
+   */
+  filter<PATH extends string>(pointer: PATH, predicate: JSONPredicate | JSONPredicate[], opts?: { toObject?: false }): JSON<JSONElementOf<T, PATH>>[];
+  filter<PATH extends string>(pointer: PATH, predicate: JSONPredicate | JSONPredicate[], opts: { toObject: true }): JSONElementOf<T, PATH>[];
+
+  /**
+   * Like `.filter()` but returns only the first matching element or `undefined`.
+   * 
+   * @param {string} pointer RFC6901-conformant JSON pointer to an array
+   * @param {JSONPredicate | JSONPredicate[]} predicate Predicate
+   * @param {object} [opts={}] Options
+   * @param {boolean} [opts.toObject=false] Return a JS object instead of `JSON` element
+   * @returns {JSON | any | undefined}
+   */
+  find<PATH extends string>(pointer: PATH, predicate: JSONPredicate | JSONPredicate[], opts?: { toObject?: false }): JSON<JSONElementOf<T, PATH>> | undefined;
+  find<PATH extends string>(pointer: PATH, predicate: JSONPredicate | JSONPredicate[], opts: { toObject: true }): JSONElementOf<T, PATH> | undefined;
+
+  /**
+   * Like `.filter()` but returns only the index of the first matching element or -1.
+   * 
+   * @param {string} pointer RFC6901-conformant JSON pointer to an array
+   * @param {JSONPredicate | JSONPredicate[]} predicate Predicate
+   * @returns {number}
+   */
+  findIndex(pointer: string, predicate: JSONPredicate | JSONPredicate[]): number;
+
+  /**
+   * Searches for a substring in all strings of the JSON element
+   * and returns the RFC6901 JSON pointers of the matching elements
+   * relative to this element.
+   * 
+   * A match in an object key returns the pointer to its value.
+   * 
+   * @param {string} needle Substring to search for
+   * @param {object} [opts={}] Options
+   * @param {boolean} [opts.keys=true] Search in the object keys
+   * @param {boolean} [opts.values=true] Search in the string values
+   * @returns {string[]}
+   */
+  search(needle: string, opts?: { keys?: boolean, values?: boolean }): string[];
+
+  /**
+   * Computes statistics over the numeric values matched by a
+   * RFC6901 JSON pointer that can contain `*` wildcards
+   * matching all members of an array or an object, without
+   * creating any JS values.
+   * 
+   * Non-numeric values and elements missing the fields after
+   * a wildcard are skipped. `min`, `max` and `mean` are `null`
+   * when no values were found.
+   * 
+   * @param {string} pointer RFC6901 JSON pointer where `*` segments are wildcards
+   * @param {string[]} [ops] Aggregations to compute, all by default
+   * @returns {Record<string, number | null>}
+   */
+  aggregate<OPS extends JSONAggregation = JSONAggregation>(pointer: string, ops?: OPS[]): JSONStatistics<OPS>;
+
+  /**
+   * Computes statistics over the numeric values matched by a
+   * RFC6901 JSON pointer that can contain `*` wildcards.
+   * 
+   * Like `.aggregate()` but runs in a background thread.
+   * 
+   * @param {string} pointer RFC6901 JSON pointer where `*` segments are wildcards
+   * @param {string[]} [ops] Aggregations to compute, all by default
+   * @returns {Promise<Record<string, number | null>>}
+   */
+  aggregateAsync<OPS extends JSONAggregation = JSONAggregation>(pointer: string, ops?: OPS[]): Promise<JSONStatistics<OPS>>;
+
   /**
    * Converts the binary representation to a JS object.
    * 
@@ -109,9 +377,24 @@ export class JSON<T = any> {
    * allows to convert only a small subtree out of a larger
    * document.
    * 
+   * With `opts.depth`, only the first levels are converted, the
+   * arrays and objects below them are returned as `JSON` elements -
+   * `{ depth: 1 }` is equivalent to `.expand()`.
+   * 
+   * `opts.pick` and `opts.omit` are lists of JSON pointers with
+   * `*` wildcards, only the picked subtrees without the omitted
+   * ones are converted, the arrays are compacted.
+   * 
+   * @param {object} [opts={}] Options
+   * @param {string[]} [opts.pick] Convert only these subtrees
+   * @param {string[]} [opts.omit] Skip these subtrees
+   * @param {number} [opts.depth] Convert only this many levels, the deeper arrays and objects are `JSON` elements
+   * @param {boolean} [opts.proxy=false] Return proxies instead of `JSON` elements below `opts.depth`
    * @returns {any}
    */
   toObject(): T;
+  toObject(opts: { pick?: string[], omit?: string[] }): any;
+  toObject(opts: { depth: number, proxy?: boolean }): any;
 
   /**
    * Converts the binary representation to a JS object.
@@ -122,16 +405,140 @@ export class JSON<T = any> {
    * Allows to convert only a small subtree out of a larger
    * document.
    * 
+   * The conversion starts after the promise has been returned.
+   * Conversions with a higher `opts.priority` are resumed first,
+   * conversions with the same priority take turns every
+   * `JSON.sliceNodes` nodes.
+   * 
+   * With `opts.offload`, the traversal of the binary representation
+   * is done in a background thread which produces a conversion plan,
+   * the main thread only creates the JS values.
+   * 
+   * With `opts.v8`, a background thread produces the V8 serialization
+   * format which is then deserialized by `v8.deserialize()` in a single
+   * call - this is the fastest method for converting large documents
+   * but it blocks the event loop during the deserialization.
+   * 
+   * `opts.pick` and `opts.omit` work as with `.toObject()`.
+   * `opts.v8` supports only `opts.signal`, combining it with any
+   * other option throws a `TypeError`.
+   * 
+   * @param {object} [opts={}] Options
+   * @param {number} [opts.latency=JSON.latency] Maximum duration of each time slice in milliseconds
+   * @param {number} [opts.priority=0] Priority in the run queue, higher runs first
+   * @param {AbortSignal} [opts.signal] Rejects the promise and stops the conversion
+   * @param {boolean} [opts.offload=false] Prepare the conversion in a background thread
+   * @param {boolean} [opts.v8=false] Convert through the V8 serialization format
+   * @param {string[]} [opts.pick] Convert only these subtrees
+   * @param {string[]} [opts.omit] Skip these subtrees
    * @returns {Promise<any>}
    */
-  toObjectAsync(): Promise<T>;
+  toObjectAsync(opts?: { latency?: number, priority?: number, signal?: AbortSignal, offload?: boolean, v8?: boolean }): Promise<T>;
+  toObjectAsync(opts: { latency?: number, priority?: number, signal?: AbortSignal, offload?: boolean, pick?: string[], omit?: string[] }): Promise<any>;
+
+  /**
+   * Converts an array to JS objects in chunks of `opts.chunkSize`
+   * elements, yielding each chunk as soon as it has been converted.
+   * 
+   * Allows to start processing the elements of a huge array before
+   * it has been fully converted, only the current and the next
+   * chunk are kept in memory.
+   * 
+   * Accepts the same options as `.toObjectAsync()`.
+   * 
+   * @param {object} [opts={}] Options
+   * @param {number} [opts.chunkSize=1024] Number of elements in each chunk
+   * @returns {AsyncGenerator<any[]>}
+   */
+  toObjectStream(opts?: { chunkSize?: number, latency?: number, priority?: number, signal?: AbortSignal }):
+    AsyncGenerator<T extends (infer U)[] ? U[] : never>;
+
+  /**
+   * Serializes the JSON element to the format of `v8.serialize()`.
+   * 
+   * @returns {Buffer}
+   */
+  toV8Buffer(): Buffer;
+
+  /**
+   * Serializes the JSON element to the format of `v8.serialize()`
+   * in a background thread.
+   * 
+   * @param {object} [opts={}] Options
+   * @param {AbortSignal} [opts.signal] Rejects the promise and skips the serialization
+   * @returns {Promise<Buffer>}
+   */
+  toV8BufferAsync(opts?: { signal?: AbortSignal }): Promise<Buffer>;
+
+  /**
+   * Serializes the JSON element to a minified JSON string
+   * directly from the binary representation.
+   * 
+   * Equivalent to `JSON.stringify(json.toObject())` but
+   * without creating the intermediate JS object.
+   * 
+   * @returns {string}
+   */
+  stringify(): string;
+
+  /**
+   * Serializes the JSON element to a minified JSON string
+   * in a background thread.
+   * 
+   * @returns {Promise<string>}
+   */
+  stringifyAsync(): Promise<string>;
+
+  /**
+   * Serializes the JSON element to a `Buffer` containing
+   * minified UTF-8 JSON directly from the binary representation.
+   * 
+   * @returns {Buffer}
+   */
+  toBuffer(): Buffer;
+
+  /**
+   * Serializes the JSON element to a `Buffer` containing
+   * minified UTF-8 JSON in a background thread.
+   * 
+   * @returns {Promise<Buffer>}
+   */
+  toBufferAsync(): Promise<Buffer>;
+
+  /**
+   * Write the whole document containing this element to a binary
+   * snapshot file that can be loaded with `JSON.load()` without
+   * parsing it again.
+   * 
+   * The snapshot is specific to the byte order of the machine.
+   * 
+   * @param {string} path file to write
+   */
+  save(path: string): void;
+
+  /**
+   * Register the document of this element for sharing with other
+   * environments (`worker_threads`) and return a token that can be
+   * sent to them and opened with `JSON.open()`.
+   * 
+   * The tape is shared read-only without copying. The token is random
+   * and remains valid as long as this object and its environment are
+   * alive.
+   * 
+   * @returns {string}
+   */
+  share(): string;
 
   /**
    * Creates a Proxy object that gives the illusion of a real object.
    * 
    * This is an instantaneous zero-latency method for creating a
    * `Proxy` object that works (almost) like a real object but
-   * calls .expand() when needs to retrieve a property.
+   * retrieves each property from the binary representation when
+   * it is accessed.
+   * 
+   * Subsequent requests for the same element will return a reference
+   * to the same proxy for as long as the GC hasn't collected it.
    * 
    * @returns {any}
    */
@@ -147,6 +554,69 @@ export class JSON<T = any> {
    */
   static latency: number;
 
+  /**
+   * Size of the dedicated thread pool for parsing.
+   * 
+   * When 0, the parse methods run on the libuv thread pool that
+   * is shared with `fs`, `dns` and `crypto`. Otherwise they run on
+   * a pool with this many threads that belongs to the environment.
+   * The value is limited to the number of CPU cores.
+   * 
+   * @property {number}
+   * @default 0
+   */
+  static threads: number;
+
+  /**
+   * Maximum number of nodes converted by `.toObjectAsync()` in each
+   * time slice before yielding to the other conversions, 0 for
+   * no limit other than the latency.
+   * 
+   * @property {number}
+   * @default 4096
+   */
+  static sliceNodes: number;
+
+  /**
+   * Target event loop delay in milliseconds for the adaptive time
+   * slicing of `.toObjectAsync()`, 0 disables it.
+   * 
+   * When enabled, the time slice is no longer `JSON.latency` but what
+   * remains of the target after the 99th percentile of the time the
+   * event loop spends on the other tasks.
+   * 
+   * @property {number}
+   * @default 0
+   */
+  static targetLoopDelay: number;
+
+  /**
+   * Returns the metrics of the `.toObjectAsync()` run queue.
+   * 
+   * The waiting times are in milliseconds, `depth` is the number
+   * of conversions currently in the queue, `clockCheck` is the
+   * number of nodes converted between two readings of the clock,
+   * adapted to the measured cost of a node, `latency` is the
+   * current time slice and `loopDelayP99` is the 99th percentile of
+   * the measured event loop delay.
+   * 
+   * @param {boolean} [reset=false] Reset the counters after reading them
+   * @returns {SchedulerStats}
+   */
+  static schedulerStats(reset?: boolean): {
+    depth: number;
+    jobs: number;
+    slices: number;
+    nodes: number;
+    sliceWaitMean: number;
+    sliceWaitMax: number;
+    jobWaitMean: number;
+    jobWaitMax: number;
+    clockCheck: number;
+    latency: number;
+    loopDelayP99: number;
+  };
+
   /**
    * The currently used simdjson version.
    * 
@@ -161,6 +631,13 @@ export class JSON<T = any> {
    */
   static readonly simd: 'icelake' | 'haswell' | 'westmere' | 'arm64' | 'ppc64' | 'fallback';
 
+  /**
+   * The type names indexed by `.typeId`.
+   * 
+   * @property {string[]}
+   */
+  static readonly types: readonly ['array', 'object', 'string', 'number', 'boolean', 'null'];
+
   /**
    * Symbol.toObject to be used for Proxies
    */
@@ -1,16 +1,17 @@
 #include "jsonAsync.h"
+#include <charconv>
 #include <sstream>
 
 JSONElementContext::JSONElementContext(Napi::Env env, const std::shared_ptr<padded_string> &_input_text,
                                        const std::shared_ptr<parser> &_parser_,
                                        const std::shared_ptr<element> &_document, const element &_root)
     : input_text(_input_text), parser_(_parser_), document(_document), store_json(Napi::MakeTracking<ObjectStore>(env)),
-      store_get(Napi::MakeTracking<ObjectStore>(env)), store_expand(Napi::MakeTracking<ObjectStore>(env)), root(_root) {
-}
+      store_get(Napi::MakeTracking<ObjectStore>(env)), store_expand(Napi::MakeTracking<ObjectStore>(env)),
+      store_proxy(Napi::MakeTracking<ObjectStore>(env)), root(_root) {}
 
 JSONElementContext::JSONElementContext(const JSONElementContext &parent, const element &_root)
     : input_text(parent.input_text), parser_(parent.parser_), document(parent.document), store_json(parent.store_json),
-      store_get(parent.store_get), store_expand(parent.store_expand), root(_root) {}
+      store_get(parent.store_get), store_expand(parent.store_expand), store_proxy(parent.store_proxy), root(_root) {}
 
 JSONElementContext::JSONElementContext() {}
 
@@ -30,33 +31,41 @@ JSON::JSON(const CallbackInfo &info) : ObjectWrap<JSON>(info) {
   store_json = context->store_json;
   store_get = context->store_get;
   store_expand = context->store_expand;
+  store_proxy = context->store_proxy;
   ProcessExternalMemory(env);
 }
 
-JSON::~JSON() { ProcessExternalMemory(Env()); }
+JSON::~JSON() {
+  if (!shared_token.empty())
+    Unshare(shared_token);
+  ProcessExternalMemory(Env());
+}
 
 std::shared_ptr<padded_string> JSON::GetString(const CallbackInfo &info) {
   Napi::Env env(info.Env());
 
-  if (info.Length() != 1 || (!info[0].IsString() && !info[0].IsBuffer())) {
-    throw TypeError::New(env, "JSON.parse{Async} expects a single string or Buffer argument");
+  if (info.Length() < 1 || (!info[0].IsString() && !info[0].IsBuffer())) {
+    throw TypeError::New(env, "JSON.parse{Async} expects a string or Buffer argument");
   }
 
-  auto parser_ = Napi::MakeTracking<parser>(env);
+  return GetString(env, info[0]);
+}
 
+std::shared_ptr<padded_string> JSON::GetString(Napi::Env env, const Napi::Value &text) {
   size_t json_len;
-  if (info[0].IsString()) {
-    napi_get_value_string_utf8(env, info[0], nullptr, 0, &json_len);
+  if (text.IsString()) {
+    napi_get_value_string_utf8(env, text, nullptr, 0, &json_len);
     auto json = Napi::MakeTracking<padded_string>(env, json_len, json_len);
-    napi_get_value_string_utf8(env, info[0], json->data(), json_len + 1, nullptr);
+    napi_get_value_string_utf8(env, text, json->data(), json_len + 1, nullptr);
     return json;
-  } else if (info[0].IsBuffer()) {
-    auto buffer = info[0].As<Buffer<char>>();
-    auto json = Napi::MakeTracking<padded_string>(env, 0, buffer.Data() + buffer.ByteOffset(), buffer.ByteLength());
+  } else if (text.IsBuffer()) {
+    // Data() already points to the first byte of the view
+    auto buffer = text.As<Buffer<char>>();
+    auto json = Napi::MakeTracking<padded_string>(env, 0, buffer.Data(), buffer.ByteLength());
     return json;
   }
 
-  throw TypeError::New(env, "JSON.Parse expects a single string or Buffer argument");
+  throw TypeError::New(env, "JSON.Parse expects a string or Buffer argument");
 }
 
 unsigned JSON::latency = 5;
@@ -73,6 +82,22 @@ void JSON::LatencySetter(const CallbackInfo &info, const Napi::Value &val) {
   latency = val.As<Number>().Int32Value();
 }
 
+Value JSON::ProxyHandlerGetter(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+  if (instance->proxy_handler.IsEmpty())
+    return env.Undefined();
+  return instance->proxy_handler.Value();
+}
+
+void JSON::ProxyHandlerSetter(const CallbackInfo &info, const Napi::Value &val) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+  if (!val.IsObject())
+    throw TypeError::New(env, "Invalid value, must be a Proxy handler object");
+  instance->proxy_handler = Persistent(val.As<Object>());
+}
+
 Value JSON::SIMDGetter(const CallbackInfo &info) {
   Napi::Env env(info.Env());
   return String::New(env, get_active_implementation()->name());
@@ -93,10 +118,17 @@ Value JSON::ToStringGetter(const CallbackInfo &info) {
 Value JSON::Parse(const CallbackInfo &info) {
   Napi::Env env(info.Env());
   auto instance = env.GetInstanceData<InstanceData>();
+  auto only = GetOnly(env, info.Length() > 1 ? info[1] : env.Undefined());
 
   try {
     auto parser_ = Napi::MakeTracking<parser>(env);
     auto json = GetString(info);
+    // Only the compact text of the selected subtrees is kept
+    if (only) {
+      auto compact = Query::Extract(*json, *only);
+      if (compact)
+        json = compact;
+    }
     // This needs https://github.com/simdjson/simdjson/issues/1017 for optimal solution
     auto document = Napi::MakeTracking<element>(env, json->length() * 2, parser_->parse(*json));
 
@@ -128,65 +160,181 @@ Value JSON::GetPrimitive(Napi::Env env, const element &el) {
   throw Error::New(env, "Invalid JSON element");
 }
 
+JSON::Hybrid::Hybrid(Napi::Env env, const JSONElementContext &parent, bool _proxy, bool _primitives)
+    : instance(env.GetInstanceData<InstanceData>()), context(parent, parent.root),
+      ctor_args(External<JSONElementContext>::New(env, &context)), proxy(_proxy), primitives(_primitives) {}
+
+// The conversion shared by get(), expand() and toObject({ depth })
+Value JSON::ToObject(Napi::Env env, const element &el, uint32_t depth, Hybrid &hybrid) {
+  bool container = el.is_array() || el.is_object();
+  if (depth == 0 && (container || hybrid.primitives)) {
+    hybrid.context.root = el;
+    auto target = New(hybrid.instance, el, store_json.get(), &hybrid.ctor_args);
+    if (!hybrid.proxy)
+      return target;
+    return NewProxy(hybrid.instance, el, store_proxy.get(), target);
+  }
+  if (!container)
+    return GetPrimitive(env, el);
+
+  EscapableHandleScope scope(env);
+  if (el.is_array()) {
+    auto array = Array::New(env, dom::array(el).size());
+    size_t i = 0;
+    for (element child : dom::array(el)) {
+      array.Set(i, ToObject(env, child, depth - 1, hybrid));
+      i++;
+    }
+    return scope.Escape(array);
+  }
+  auto object = Object::New(env);
+  for (auto field : dom::object(el)) {
+    object.Set(field.key.data(), ToObject(env, field.value, depth - 1, hybrid));
+  }
+  return scope.Escape(object);
+}
+
 Value JSON::Get(Napi::Env env, bool expand) {
   ObjectStore *store = expand ? store_expand.get() : store_get.get();
   TRY_RETURN_FROM_STORE(store, root);
 
-  auto instance = env.GetInstanceData<InstanceData>();
-  Napi::Value sub;
   try {
-    switch (root.type()) {
-    case element_type::ARRAY: {
-      size_t len = dom::array(root).size();
-      auto array = Array::New(env, len);
+    if (!root.is_array() && !root.is_object())
+      return GetPrimitive(env, root);
+    Hybrid hybrid(env, *this, false, !expand);
+    auto result = ToObject(env, root, 1, hybrid);
+    store->emplace(root, Weak(result.As<Object>()));
+    return result;
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
 
-      JSONElementContext context(*this);
-      napi_value ctor_args = External<JSONElementContext>::New(env, &context);
+Value JSON::Get(const CallbackInfo &info) { return Get(info.Env(), false); }
+Value JSON::Expand(const CallbackInfo &info) { return Get(info.Env(), true); }
+Value JSON::ToObject(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  Napi::Value options = info.Length() > 0 ? info[0] : env.Undefined();
+  auto projection = GetProjection(env, options);
 
-      size_t i = 0;
-      for (element child : dom::array(root)) {
-        if (!expand || (child.is_array() || child.is_object())) {
-          context.root = child;
-          sub = New(instance, child, store_json.get(), &ctor_args);
-        } else
-          sub = GetPrimitive(env, child);
-        array.Set(i, sub);
-        i++;
-      }
-      store->emplace(root, Weak(array.As<Object>()));
-      return array;
+  Napi::Value opt = options.IsObject() ? options.As<Object>().Get("depth") : env.Undefined();
+  if (!opt.IsUndefined()) {
+    if (!opt.IsNumber() || !(opt.As<Number>().DoubleValue() >= 0)) {
+      throw TypeError::New(env, "depth must be a positive number or 0");
     }
-    case element_type::OBJECT: {
-      auto object = Object::New(env);
-
-      JSONElementContext context(*this);
-      napi_value ctor_args = External<JSONElementContext>::New(env, &context);
-
-      for (auto field : dom::object(root)) {
-        const auto &child = field.value;
-        if (!expand || (child.is_array() || child.is_object())) {
-          context.root = child;
-          sub = New(instance, child, store_json.get(), &ctor_args);
-        } else
-          sub = GetPrimitive(env, child);
-        object.Set(field.key.data(), sub);
-      }
-      store->emplace(root, Weak(object));
-      return object;
+    if (projection) {
+      throw TypeError::New(env, "depth cannot be combined with pick or omit");
     }
-    default:
-      return GetPrimitive(env, root);
+    // Infinity converts everything
+    double depth = std::min<double>(opt.As<Number>().DoubleValue(), std::numeric_limits<uint32_t>::max());
+    bool proxy = options.As<Object>().Get("proxy").ToBoolean().Value();
+    if (proxy && env.GetInstanceData<InstanceData>()->proxy_handler.IsEmpty()) {
+      throw Error::New(env, "Proxy handler is not installed");
+    }
+    try {
+      Hybrid hybrid(env, *this, proxy, false);
+      return ToObject(env, root, static_cast<uint32_t>(depth), hybrid);
+    } catch (const exception &err) {
+      throw Error::New(env, err.what());
     }
+  }
+
+  if (projection) {
+    try {
+      return ToObject(env, root, *projection, projection->Root());
+    } catch (const exception &err) {
+      throw Error::New(env, err.what());
+    }
+  }
+  return ToObject(env, root);
+}
+
+// The { pick, omit } options, nullptr if there are none
+std::shared_ptr<Query::Projection> JSON::GetProjection(Napi::Env env, const Napi::Value &options) {
+  if (options.IsUndefined())
+    return nullptr;
+  if (!options.IsObject()) {
+    throw TypeError::New(env, "options must be an object");
+  }
+  auto pick = GetPointers(env, options, "pick");
+  auto omit = GetPointers(env, options, "omit");
+  if (pick.empty() && omit.empty())
+    return nullptr;
+
+  try {
+    return std::make_shared<Query::Projection>(pick, omit);
   } catch (const exception &err) {
     throw Error::New(env, err.what());
   }
+}
 
-  throw Error::New(env, "Invalid JSON element");
+// The { only } option of JSON.parse() / JSON.parseAsync(), nullptr if there is none
+std::shared_ptr<Query::Projection> JSON::GetOnly(Napi::Env env, const Napi::Value &options) {
+  if (options.IsUndefined())
+    return nullptr;
+  if (!options.IsObject()) {
+    throw TypeError::New(env, "options must be an object");
+  }
+  auto only = GetPointers(env, options, "only");
+  if (only.empty())
+    return nullptr;
+
+  try {
+    return std::make_shared<Query::Projection>(only, vector<string>());
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
 }
 
-Value JSON::Get(const CallbackInfo &info) { return Get(info.Env(), false); }
-Value JSON::Expand(const CallbackInfo &info) { return Get(info.Env(), true); }
-Value JSON::ToObject(const CallbackInfo &info) { return ToObject(info.Env(), root); }
+vector<string> JSON::GetPointers(Napi::Env env, const Napi::Value &options, const char *name) {
+  vector<string> list;
+  Napi::Value opt = options.As<Object>().Get(name);
+  if (opt.IsUndefined())
+    return list;
+  if (!opt.IsArray()) {
+    throw TypeError::New(env, string(name) + " must be an array of RFC6901 paths");
+  }
+  auto array = opt.As<Array>();
+  for (size_t i = 0; i < array.Length(); i++) {
+    Napi::Value pointer = array.Get(i);
+    if (!pointer.IsString()) {
+      throw TypeError::New(env, string(name) + " must be an array of RFC6901 paths");
+    }
+    list.push_back(pointer.As<String>().Utf8Value());
+  }
+  return list;
+}
+
+// The skipped members are never converted, the arrays are compacted
+Value JSON::ToObject(Napi::Env env, const element &root, const Query::Projection &projection,
+                     const Query::Projection::State &state) {
+  if (Query::Projection::All(state))
+    return ToObject(env, root);
+
+  EscapableHandleScope scope(env);
+  Query::Projection::State child;
+  switch (root.type()) {
+  case element_type::ARRAY: {
+    auto array = Array::New(env);
+    size_t i = 0, len = 0;
+    for (element el : dom::array(root)) {
+      if (projection.Enter(state, i++, el, child))
+        array.Set(len++, ToObject(env, el, projection, child));
+    }
+    return scope.Escape(array);
+  }
+  case element_type::OBJECT: {
+    auto object = Object::New(env);
+    for (auto field : dom::object(root)) {
+      if (projection.Enter(state, field.key, field.value, child))
+        object.Set(field.key.data(), ToObject(env, field.value, projection, child));
+    }
+    return scope.Escape(object);
+  }
+  default:
+    return scope.Escape(ToObject(env, root));
+  }
+}
 
 Value JSON::ToObject(Napi::Env env, const element &root) {
   EscapableHandleScope scope(env);
@@ -235,10 +383,9 @@ Value JSON::ToObject(Napi::Env env, const element &root) {
   return scope.Escape(result);
 }
 
-Value JSON::Path(const CallbackInfo &info) {
+// The arguments of path() and pathAsync()
+bool JSON::GetThrowOnError(const CallbackInfo &info) {
   Napi::Env env(info.Env());
-  auto instance = env.GetInstanceData<InstanceData>();
-  bool throwOnError = true;
 
   if (info.Length() < 1 || !info[0].IsString()) {
     throw TypeError::New(env, "No RFC6901 path given");
@@ -247,8 +394,17 @@ Value JSON::Path(const CallbackInfo &info) {
     if (!info[1].IsObject()) {
       throw TypeError::New(env, "options must be an object");
     }
-    throwOnError = info[1].As<Object>().Get("throwOnError").As<Boolean>().Value();
+    Napi::Value opt = info[1].As<Object>().Get("throwOnError");
+    if (!opt.IsUndefined())
+      return opt.As<Boolean>().Value();
   }
+  return true;
+}
+
+Value JSON::Path(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+  bool throwOnError = GetThrowOnError(info);
 
   try {
     auto path = info[0].As<String>().Utf8Value();
@@ -265,8 +421,29 @@ Value JSON::Path(const CallbackInfo &info) {
   }
 }
 
+JSONTypeId JSON::GetTypeId(const element &el) {
+  switch (el.type()) {
+  case element_type::ARRAY:
+    return JSON_ARRAY;
+  case element_type::OBJECT:
+    return JSON_OBJECT;
+  case element_type::STRING:
+    return JSON_STRING;
+  case element_type::DOUBLE:
+  case element_type::INT64:
+  case element_type::UINT64:
+    return JSON_NUMBER;
+  case element_type::BOOL:
+    return JSON_BOOLEAN;
+  case element_type::NULL_VALUE:
+    return JSON_NULL;
+  }
+  throw runtime_error("Invalid JSON element");
+}
+
 Value JSON::TypeGetter(const CallbackInfo &info) {
   Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
   try {
     // This would have greatly benefited from String references in NAPI
     // Alas, I am currently blocked from discussions in Node.js as
@@ -274,25 +451,96 @@ Value JSON::TypeGetter(const CallbackInfo &info) {
     // in the French police and judicial system in which the Node.js core
     // team is involved
     // (I was blocked for https://github.com/nodejs/node-gyp/issues/2903)
-    switch (root.type()) {
-    case element_type::ARRAY:
-      return String::New(env, "array");
-    case element_type::OBJECT:
-      return String::New(env, "object");
-    case element_type::STRING:
-      return String::New(env, "string");
-    case element_type::DOUBLE:
-    case element_type::INT64:
-    case element_type::UINT64:
-      return String::New(env, "number");
-    case element_type::BOOL:
-      return String::New(env, "boolean");
-    case element_type::NULL_VALUE:
-      return String::New(env, "null");
-    default:
-      throw Error::New(env, "Invalid JSON element");
+    // The type names are persistent strings created once per environment
+    return instance->type_names[GetTypeId(root)].Value();
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
+
+Value JSON::TypeIdGetter(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  try {
+    return Number::New(env, GetTypeId(root));
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
+
+Value JSON::Proxify(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+
+  if (instance->proxy_handler.IsEmpty()) {
+    throw Error::New(env, "Proxy handler is not installed");
+  }
+  return NewProxy(instance, root, store_proxy.get(), info.This());
+}
+
+// Looks up an object member or an array element by its property name
+static bool FindProperty(const element &root, const std::string &prop, element &child) {
+  switch (root.type()) {
+  case element_type::OBJECT:
+    return dom::object(root).at_key(prop).get(child) == SUCCESS;
+  case element_type::ARRAY: {
+    size_t idx;
+    auto end = prop.data() + prop.size();
+    auto r = from_chars(prop.data(), end, idx);
+    return !prop.empty() && r.ec == errc() && r.ptr == end && dom::array(root).at(idx).get(child) == SUCCESS;
+  }
+  default:
+    return false;
+  }
+}
+
+// The Proxy get trap in a single call: looks up the property
+// and returns either a primitive value or the (cached) proxy of the sub-element
+Value JSON::ProxyGet(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+
+  if (info.Length() != 1 || !info[0].IsString()) {
+    throw TypeError::New(env, "proxyGet expects a single string argument");
+  }
+
+  try {
+    auto prop = info[0].As<String>().Utf8Value();
+    if (root.is_array() && prop == "length")
+      return Number::New(env, dom::array(root).size());
+    element child;
+    if (!FindProperty(root, prop, child))
+      return env.Undefined();
+
+    if (child.is_array() || child.is_object()) {
+      JSONElementContext context(*this, child);
+      napi_value ctor_args = External<JSONElementContext>::New(env, &context);
+      auto target = New(instance, child, store_json.get(), &ctor_args);
+      return NewProxy(instance, child, store_proxy.get(), target);
     }
+    return GetPrimitive(env, child);
   } catch (const exception &err) {
     throw Error::New(env, err.what());
   }
 }
+
+// The Proxy has / getOwnPropertyDescriptor traps, answered
+// from the tape without creating the sub-element
+Value JSON::ProxyHas(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+
+  if (info.Length() != 1 || !info[0].IsString()) {
+    throw TypeError::New(env, "proxyHas expects a single string argument");
+  }
+
+  try {
+    auto prop = info[0].As<String>().Utf8Value();
+    element child;
+    return Boolean::New(env, (root.is_array() && prop == "length") || FindProperty(root, prop, child));
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
+
+// The get trap forwards the symbols to the target, this
+// is how the native code finds the JSON behind a proxy
+Value JSON::ProxyTargetGetter(const CallbackInfo &info) { return info.This(); }
@@ -0,0 +1,57 @@
+#include "jsonAsync.h"
+
+// AbortSignal support for the asynchronous operations
+
+Cancellation::Cancellation() : aborted(false), deferred(nullptr) {}
+
+void Cancellation::Release() {
+  if (listener.IsEmpty())
+    return;
+  Napi::Env env = signal.Env();
+  HandleScope scope(env);
+  Object target = signal.Value();
+  target.Get("removeEventListener").As<Function>().Call(target, {String::New(env, "abort"), listener.Value()});
+  listener.Reset();
+  signal.Reset();
+}
+
+void Cancellation::Listen(Napi::Env env, const Napi::Value &options, Promise::Deferred &_deferred) {
+  if (!options.IsObject())
+    return;
+  Napi::Value opt = options.As<Object>().Get("signal");
+  if (opt.IsUndefined())
+    return;
+  if (!opt.IsObject() || !opt.As<Object>().Get("addEventListener").IsFunction()) {
+    throw TypeError::New(env, "signal must be an AbortSignal");
+  }
+
+  deferred = &_deferred;
+  signal = Persistent(opt.As<Object>());
+  if (signal.Value().Get("aborted").ToBoolean().Value()) {
+    Abort(env);
+    return;
+  }
+
+  // Release() removes the listener before this object is destroyed
+  auto fn = Function::New(env, [this](const CallbackInfo &info) { Abort(info.Env()); }, "abort");
+  listener = Persistent(fn);
+  auto once = Object::New(env);
+  once.Set("once", Boolean::New(env, true));
+  Object target = signal.Value();
+  target.Get("addEventListener").As<Function>().Call(target, {String::New(env, "abort"), fn, once});
+}
+
+void Cancellation::Abort(Napi::Env env) {
+  if (aborted.exchange(true))
+    return;
+  // A once listener has already been removed
+  listener.Reset();
+  Napi::Value reason = signal.Value().Get("reason");
+  if (reason.IsUndefined()) {
+    auto error = Error::New(env, "The operation was aborted");
+    error.Set("name", String::New(env, "AbortError"));
+    reason = error.Value();
+  }
+  signal.Reset();
+  deferred->Reject(reason);
+}
@@ -0,0 +1,73 @@
+#include "jsonAsync.h"
+
+static unsigned GetAggregateOps(Napi::Env env, const CallbackInfo &info) {
+  if (info.Length() < 1 || !info[0].IsString()) {
+    throw TypeError::New(env, "No RFC6901 path given");
+  }
+  if (info.Length() < 2 || info[1].IsUndefined()) {
+    return Query::Statistics::ALL;
+  }
+  if (!info[1].IsArray()) {
+    throw TypeError::New(env, "operations must be an array");
+  }
+
+  static const map<string, unsigned> names = {{"sum", Query::Statistics::SUM},
+                                              {"min", Query::Statistics::MIN},
+                                              {"max", Query::Statistics::MAX},
+                                              {"count", Query::Statistics::COUNT},
+                                              {"mean", Query::Statistics::MEAN}};
+  auto list = info[1].As<Array>();
+  unsigned ops = 0;
+  for (size_t i = 0; i < list.Length(); i++) {
+    Napi::Value op = list.Get(i);
+    auto it = op.IsString() ? names.find(op.As<String>().Utf8Value()) : names.end();
+    if (it == names.end()) {
+      throw TypeError::New(env, "Invalid operation, must be one of sum, min, max, count, mean");
+    }
+    ops |= it->second;
+  }
+  return ops;
+}
+
+Value JSON::Aggregate(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  unsigned ops = GetAggregateOps(env, info);
+
+  try {
+    auto pattern = Query::Parse(info[0].As<String>().Utf8Value());
+    Query::Statistics stats;
+    Query::Walk(root, pattern, 0, [&stats](const element &el) { stats.Add(el); });
+    return stats.ToObject(env, ops);
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
+
+Value JSON::AggregateAsync(const CallbackInfo &info) {
+  class AggregateAsyncWorker : public JSONAsyncWorker {
+    Query::Pattern pattern;
+    unsigned ops;
+    Query::Statistics stats;
+
+  public:
+    AggregateAsyncWorker(Napi::Env env, const JSONElementContext &_context, const string &pointer, unsigned _ops)
+        : JSONAsyncWorker(env, _context), pattern(Query::Parse(pointer)), ops(_ops) {}
+    virtual void Execute() override {
+      Query::Walk(context.root, pattern, 0, [this](const element &el) { stats.Add(el); });
+    }
+    virtual void OnOK() override { deferred.Resolve(stats.ToObject(Env(), ops)); }
+  };
+
+  Napi::Env env(info.Env());
+  unsigned ops = GetAggregateOps(env, info);
+
+  AggregateAsyncWorker *worker;
+  try {
+    worker = new AggregateAsyncWorker(env, *this, info[0].As<String>().Utf8Value(), ops);
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+
+  worker->Queue();
+  return worker->GetPromise();
+}
@@ -0,0 +1,90 @@
+#include "jsonAsync.h"
+
+// JSON.parse(text, { only }) / JSON.parseAsync(text, { only })
+//
+// An On-Demand pass copies the selected subtrees to a compact JSON text,
+// only this text is parsed to a DOM tape - the tape and the kept text
+// are proportional to the selected data and not to the whole document
+
+namespace Query {
+
+namespace {
+
+class Extractor {
+  const Projection &projection;
+  std::string &out;
+
+  static bool IsContainer(ondemand::json_type type) {
+    return type == ondemand::json_type::array || type == ondemand::json_type::object;
+  }
+
+public:
+  Extractor(const Projection &_projection, std::string &_out) : projection(_projection), out(_out) {}
+
+  // The nesting is limited by the maximum depth of the parser
+  void Extract(ondemand::value &value, const Projection::State &state) {
+    // The whole subtree is copied without being parsed
+    if (Projection::All(state)) {
+      out.append(std::string_view(value.raw_json()));
+      return;
+    }
+
+    Projection::State child;
+    bool first = true;
+    switch (value.type()) {
+    case ondemand::json_type::object:
+      out.push_back('{');
+      for (ondemand::field field : value.get_object()) {
+        std::string_view escaped = field.escaped_key();
+        std::string_view key = escaped.find('\\') == std::string_view::npos ? escaped : field.unescaped_key();
+        ondemand::value &member = field.value();
+        if (!projection.Enter(state, key, IsContainer(member.type()), child))
+          continue;
+        if (!first)
+          out.push_back(',');
+        first = false;
+        out.push_back('"');
+        out.append(escaped);
+        out.append("\":");
+        Extract(member, child);
+      }
+      out.push_back('}');
+      break;
+    case ondemand::json_type::array: {
+      out.push_back('[');
+      size_t i = 0;
+      for (ondemand::value el : value.get_array()) {
+        if (!projection.Enter(state, i++, IsContainer(el.type()), child))
+          continue;
+        if (!first)
+          out.push_back(',');
+        first = false;
+        Extract(el, child);
+      }
+      out.push_back(']');
+      break;
+    }
+    default:
+      out.append(std::string_view(value.raw_json()));
+    }
+  }
+};
+
+} // namespace
+
+std::shared_ptr<padded_string> Extract(const padded_string &text, const Projection &projection) {
+  ondemand::parser scanner;
+  ondemand::document doc = scanner.iterate(text);
+  // A scalar document is not worth extracting
+  if (doc.is_scalar())
+    return nullptr;
+
+  std::string out;
+  ondemand::value root = doc.get_value();
+  Extractor(projection, out).Extract(root, projection.Root());
+  if (!doc.at_end())
+    throw simdjson_error(TRAILING_CONTENT);
+  return std::make_shared<padded_string>(out);
+}
+
+} // namespace Query
@@ -0,0 +1,200 @@
+#include "jsonAsync.h"
+
+namespace Query {
+
+static bool Equals(const element &el, const Condition::Operand &operand) {
+  switch (operand.type) {
+  case element_type::STRING: {
+    std::string_view value;
+    return el.get_string().get(value) == SUCCESS && value == operand.text;
+  }
+  case element_type::DOUBLE: {
+    double value;
+    return el.get_double().get(value) == SUCCESS && value == operand.number;
+  }
+  case element_type::BOOL: {
+    bool value;
+    return el.get_bool().get(value) == SUCCESS && value == operand.boolean;
+  }
+  case element_type::NULL_VALUE:
+    return el.is_null();
+  default:
+    return false;
+  }
+}
+
+// Returns <0, 0 or >0, comparable is false when the types do not match
+static int Compare(const element &el, const Condition::Operand &operand, bool &comparable) {
+  comparable = true;
+  if (operand.type == element_type::STRING) {
+    std::string_view value;
+    if (el.get_string().get(value) == SUCCESS)
+      return value.compare(operand.text);
+  } else if (operand.type == element_type::DOUBLE) {
+    double value;
+    if (el.get_double().get(value) == SUCCESS)
+      return value < operand.number ? -1 : value > operand.number ? 1 : 0;
+  }
+  comparable = false;
+  return 0;
+}
+
+bool Condition::Match(const element &record) const {
+  element el = record;
+  if (!field.empty() && record.at_pointer(field).get(el) != SUCCESS)
+    return false;
+
+  bool comparable;
+  switch (op) {
+  case EQ:
+    return Equals(el, operands[0]);
+  case IN:
+    for (const auto &operand : operands)
+      if (Equals(el, operand))
+        return true;
+    return false;
+  case LT:
+    return Compare(el, operands[0], comparable) < 0 && comparable;
+  case GT:
+    return Compare(el, operands[0], comparable) > 0 && comparable;
+  case PREFIX: {
+    std::string_view value;
+    return el.get_string().get(value) == SUCCESS && value.substr(0, operands[0].text.size()) == operands[0].text;
+  }
+  }
+  return false;
+}
+
+} // namespace Query
+
+static Query::Condition::Operand GetOperand(Napi::Env env, const Napi::Value &value, bool ordered) {
+  Query::Condition::Operand operand;
+  if (value.IsString()) {
+    operand.type = element_type::STRING;
+    operand.text = value.As<String>().Utf8Value();
+  } else if (value.IsNumber()) {
+    operand.type = element_type::DOUBLE;
+    operand.number = value.As<Number>().DoubleValue();
+  } else if (value.IsBoolean() && !ordered) {
+    operand.type = element_type::BOOL;
+    operand.boolean = value.As<Boolean>().Value();
+  } else if (value.IsNull() && !ordered) {
+    operand.type = element_type::NULL_VALUE;
+  } else {
+    throw TypeError::New(env, ordered ? "lt/gt expect a number or a string" : "eq/in expect primitive values");
+  }
+  return operand;
+}
+
+static void GetConditions(Napi::Env env, const Napi::Value &value, Query::Predicate &predicate) {
+  if (!value.IsObject() || value.IsArray()) {
+    throw TypeError::New(env, "predicate must be an object or an array of objects");
+  }
+  auto object = value.As<Object>();
+
+  string field;
+  Napi::Value js_field = object.Get("field");
+  if (!js_field.IsUndefined()) {
+    if (!js_field.IsString())
+      throw TypeError::New(env, "field must be a RFC6901 path");
+    field = js_field.As<String>().Utf8Value();
+  }
+
+  size_t count = predicate.size();
+  Napi::Value operand;
+  if (!(operand = object.Get("eq")).IsUndefined()) {
+    predicate.push_back({field, Query::Condition::EQ, {GetOperand(env, operand, false)}});
+  }
+  if (!(operand = object.Get("in")).IsUndefined()) {
+    if (!operand.IsArray())
+      throw TypeError::New(env, "in expects an array");
+    auto list = operand.As<Array>();
+    Query::Condition condition{field, Query::Condition::IN, {}};
+    for (size_t i = 0; i < list.Length(); i++)
+      condition.operands.push_back(GetOperand(env, list.Get(i), false));
+    predicate.push_back(condition);
+  }
+  if (!(operand = object.Get("lt")).IsUndefined()) {
+    predicate.push_back({field, Query::Condition::LT, {GetOperand(env, operand, true)}});
+  }
+  if (!(operand = object.Get("gt")).IsUndefined()) {
+    predicate.push_back({field, Query::Condition::GT, {GetOperand(env, operand, true)}});
+  }
+  if (!(operand = object.Get("prefix")).IsUndefined()) {
+    if (!operand.IsString())
+      throw TypeError::New(env, "prefix expects a string");
+    predicate.push_back({field, Query::Condition::PREFIX, {GetOperand(env, operand, true)}});
+  }
+  if (predicate.size() == count) {
+    throw TypeError::New(env, "predicate must have at least one of eq, in, lt, gt, prefix");
+  }
+}
+
+Value JSON::Scan(const CallbackInfo &info, ScanMode mode) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+  bool toObject = false;
+
+  if (info.Length() < 2 || !info[0].IsString()) {
+    throw TypeError::New(env, "No RFC6901 path given");
+  }
+  Query::Predicate predicate;
+  if (info[1].IsArray()) {
+    auto list = info[1].As<Array>();
+    for (size_t i = 0; i < list.Length(); i++)
+      GetConditions(env, list.Get(i), predicate);
+  } else {
+    GetConditions(env, info[1], predicate);
+  }
+  if (info.Length() > 2) {
+    if (!info[2].IsObject()) {
+      throw TypeError::New(env, "options must be an object");
+    }
+    toObject = info[2].As<Object>().Get("toObject").ToBoolean().Value();
+  }
+
+  try {
+    auto path = info[0].As<String>().Utf8Value();
+    dom::array array = root.at_pointer(path).get_array();
+
+    JSONElementContext context(*this);
+    napi_value ctor_args = External<JSONElementContext>::New(env, &context);
+    auto wrap = [&](const element &el) -> Napi::Value {
+      if (toObject)
+        return ToObject(env, el);
+      context.root = el;
+      return New(instance, el, store_json.get(), &ctor_args);
+    };
+
+    auto result = Array::New(env);
+    size_t i = 0, found = 0;
+    for (element child : array) {
+      if (Query::Match(predicate, child)) {
+        switch (mode) {
+        case SCAN_FIND_INDEX:
+          return Number::New(env, i);
+        case SCAN_FIND:
+          return wrap(child);
+        case SCAN_FILTER:
+          result.Set(found++, wrap(child));
+        }
+      }
+      i++;
+    }
+
+    switch (mode) {
+    case SCAN_FIND_INDEX:
+      return Number::New(env, -1);
+    case SCAN_FIND:
+      return env.Undefined();
+    default:
+      return result;
+    }
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
+
+Value JSON::Filter(const CallbackInfo &info) { return Scan(info, SCAN_FILTER); }
+Value JSON::Find(const CallbackInfo &info) { return Scan(info, SCAN_FIND); }
+Value JSON::FindIndex(const CallbackInfo &info) { return Scan(info, SCAN_FIND_INDEX); }
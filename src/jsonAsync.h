@@ -3,12 +3,17 @@
 #define SIMDJSON_EXCEPTIONS 1
 #include "simdjson.h"
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <limits>
 #include <map>
 #include <mutex>
 #include <queue>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 #define NAPI_VERSION 8
 #include <napi.h>
@@ -22,6 +27,13 @@ using namespace chrono;
 
 typedef map<element, ObjectReference> ObjectStore;
 
+/**
+ * The JSON types as seen from JavaScript,
+ * .typeId is the index in JSONTypeNames
+ */
+enum JSONTypeId { JSON_ARRAY = 0, JSON_OBJECT, JSON_STRING, JSON_NUMBER, JSON_BOOLEAN, JSON_NULL, JSON_TYPES };
+static const char *const JSONTypeNames[JSON_TYPES] = {"array", "object", "string", "number", "boolean", "null"};
+
 /**
  * The internal information required to identify a JSON element
  * in the simdjson parsed binary representation.
@@ -41,7 +53,7 @@ struct JSONElementContext {
   std::shared_ptr<element> document;
 
   // The object store - contains weak refs to objects returned to JS
-  std::shared_ptr<ObjectStore> store_json, store_get, store_expand;
+  std::shared_ptr<ObjectStore> store_json, store_get, store_expand, store_proxy;
 
   // The root of this subvalue
   element root;
@@ -52,6 +64,200 @@ struct JSONElementContext {
   JSONElementContext();
 };
 
+namespace Query {
+
+/**
+ * An RFC6901 JSON pointer extended with wildcard segments (`*`)
+ * that match all members of an array or an object.
+ *
+ * It is stored split at the wildcards, the pointer to the prices
+ * of all items is stored as { "/items", "/price" }
+ */
+typedef vector<string> Pattern;
+
+Pattern Parse(const string &);
+
+/**
+ * Call fn for every element matching the pattern
+ *
+ * The part before the first wildcard must exist,
+ * elements missing the fields after a wildcard are skipped.
+ */
+template <typename F> void Walk(const element &el, const Pattern &pattern, size_t level, F &&fn) {
+  element sub = el;
+  if (!pattern[level].empty()) {
+    auto error = el.at_pointer(pattern[level]).get(sub);
+    if (error) {
+      if (level == 0)
+        throw simdjson_error(error);
+      return;
+    }
+  }
+
+  if (level == pattern.size() - 1) {
+    fn(sub);
+    return;
+  }
+
+  switch (sub.type()) {
+  case element_type::ARRAY:
+    for (element child : dom::array(sub))
+      Walk(child, pattern, level + 1, fn);
+    break;
+  case element_type::OBJECT:
+    for (auto field : dom::object(sub))
+      Walk(field.value, pattern, level + 1, fn);
+    break;
+  default:
+    if (level == 0)
+      throw simdjson_error(INCORRECT_TYPE);
+  }
+}
+
+/**
+ * Running statistics for JSON.aggregate()
+ */
+struct Statistics {
+  enum { SUM = 1, MIN = 2, MAX = 4, COUNT = 8, MEAN = 16, ALL = 31 };
+  size_t count;
+  double sum, min, max;
+  Statistics();
+  inline void Add(const element &);
+  Napi::Value ToObject(Napi::Env, unsigned) const;
+};
+
+inline void Statistics::Add(const element &el) {
+  double value;
+  if (el.get_double().get(value) != SUCCESS)
+    return;
+  count++;
+  sum += value;
+  min = std::min(min, value);
+  max = std::max(max, value);
+}
+
+/**
+ * A single condition of a JSON.filter() predicate evaluated on the
+ * element found at field (an RFC6901 pointer relative to the record)
+ */
+struct Condition {
+  enum Op { EQ, IN, LT, GT, PREFIX };
+  // A primitive JSON value converted from JS
+  struct Operand {
+    element_type type;
+    double number;
+    bool boolean;
+    string text;
+  };
+  string field;
+  Op op;
+  vector<Operand> operands;
+  bool Match(const element &) const;
+};
+
+typedef vector<Condition> Predicate;
+
+inline bool Match(const Predicate &predicate, const element &record) {
+  for (const auto &condition : predicate)
+    if (!condition.Match(record))
+      return false;
+  return true;
+}
+
+/**
+ * The { pick, omit } projections of toObject(), lists of RFC6901 pointers
+ * with wildcards relative to the converted element stored as tries
+ *
+ * pick keeps only the matched subtrees and the containers leading to them,
+ * omit removes the matched subtrees, the arrays are compacted
+ */
+class Projection {
+public:
+  /**
+   * The matching nodes of an element, empty pick
+   * and all set means that the whole subtree is picked
+   */
+  struct State {
+    bool all;
+    vector<uint32_t> pick, omit;
+  };
+
+  Projection(const vector<string> &pick, const vector<string> &omit);
+  State Root() const;
+  // Returns false if the member or the element must be skipped
+  bool Enter(const State &parent, std::string_view key, const element &value, State &child) const;
+  bool Enter(const State &parent, size_t index, const element &value, State &child) const;
+  // For the values that are not in a DOM tape
+  bool Enter(const State &parent, std::string_view key, bool container, State &child) const;
+  bool Enter(const State &parent, size_t index, bool container, State &child) const;
+  // A subtree that is neither filtered by pick nor by omit
+  static bool All(const State &state) { return state.all && state.omit.empty(); }
+
+private:
+  static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+  struct Node {
+    map<string, uint32_t, std::less<>> children;
+    uint32_t wildcard;
+    bool terminal;
+  };
+  vector<Node> nodes;
+  uint32_t pick, omit;
+
+  uint32_t NewNode();
+  void Add(uint32_t root, const string &pointer);
+  template <typename K> bool Match(const State &parent, const K &key, bool container, State &child) const;
+};
+
+// The compact JSON text of the subtrees selected by a projection,
+// nullptr if the whole text must be parsed
+std::shared_ptr<padded_string> Extract(const padded_string &, const Projection &);
+
+}; // namespace Query
+
+namespace Tape {
+
+// The number of used 64-bit words in the tape of a parsed document
+size_t Length(const document &);
+// The number of used bytes in the string buffer of a parsed document
+size_t StringsLength(const document &);
+// Write a parsed document to a binary snapshot file
+void Save(const document &, const std::string &);
+// Map a binary snapshot file and return a parser holding its document
+std::shared_ptr<parser> Load(const std::string &, bool validate);
+// Copy the words [from, to) of a tape to dst at index, relocating the
+// container indices and shifting the string offsets by strings_offset
+void Relocate(uint64_t *dst, size_t index, const uint64_t *src, size_t from, size_t to, uint64_t strings_offset);
+
+}; // namespace Tape
+
+/**
+ * The cancellation of an asynchronous operation through
+ * the AbortSignal passed in its { signal } option
+ *
+ * The abort listener runs on the main thread, it rejects the promise
+ * and raises the flag which can be polled from any thread.
+ * An operation that settles its promise itself must call Release().
+ */
+class Cancellation {
+  std::atomic<bool> aborted;
+  ObjectReference signal;
+  FunctionReference listener;
+  Promise::Deferred *deferred;
+
+  void Abort(Napi::Env);
+
+public:
+  Cancellation();
+  Cancellation(const Cancellation &) = delete;
+  Cancellation &operator=(const Cancellation &) = delete;
+
+  // Subscribes to options.signal, an already aborted signal rejects immediately
+  void Listen(Napi::Env, const Napi::Value &options, Promise::Deferred &);
+  bool Aborted() const { return aborted.load(std::memory_order_relaxed); }
+  // Removes the listener, must be called on the main thread
+  void Release();
+};
+
 namespace ToObjectAsync {
 
 /**
@@ -71,10 +277,40 @@ struct Element {
     } object;
   } iterator;
   Reference<Value> ref;
-  size_t idx;
+  // The index in the JS array and in the JSON array
+  size_t idx, pos;
+  // Only with a { pick, omit } projection
+  Query::Projection::State projection;
   Element(const element &);
 };
 
+/**
+ * A conversion plan built in a background thread by toObjectAsync({ offload: true })
+ *
+ * The subtree is flattened to a linear program, the main thread only
+ * creates the JS values. Each instruction is an opcode followed by its
+ * operand: the length of an array, an index in keys, strings or numbers.
+ * END closes the current array or object.
+ */
+struct Program {
+  enum Op : uint32_t { ARRAY, OBJECT, KEY, STRING, NUMBER, TRUE_VALUE, FALSE_VALUE, NULL_VALUE, END };
+  vector<uint32_t> code;
+  // The keys are deduplicated, the strings point into the document
+  vector<std::string_view> keys;
+  vector<std::string_view> strings;
+  vector<double> numbers;
+};
+
+/**
+ * An array or an object being filled by a Program
+ */
+struct Frame {
+  Reference<Value> ref;
+  bool object;
+  uint32_t idx;
+  uint32_t key;
+};
+
 /**
  * This is the state information for the iterative tree
  * traversal of ToObjectAsync
@@ -89,17 +325,197 @@ struct Context {
   // (it is a vector because we need to access the last two elements)
   vector<Element> stack;
   Promise::Deferred deferred;
+  // An aborted conversion is dropped from the queue
+  Cancellation cancel;
+  // The { pick, omit } option
+  std::shared_ptr<Query::Projection> projection;
+  // The offloaded conversion plan, its position and the open containers
+  std::shared_ptr<Program> program;
+  size_t pc;
+  vector<Frame> frames;
+  // The JS strings of the program keys, created on first use
+  Reference<Array> keys;
+  // The time slice in ms, the priority and the position in the run queue
+  unsigned latency;
+  int priority;
+  uint64_t seq;
+  // When it was put in the line and the total time spent waiting
+  high_resolution_clock::time_point queued;
+  high_resolution_clock::duration waited;
   Context(Napi::Env, Napi::Value);
 };
 
+/**
+ * The event loop delay seen by the run queue - the gap between
+ * uv_async_send() and the callback - over the last samples
+ */
+struct LoopDelay {
+  static constexpr size_t window = 128;
+  high_resolution_clock::time_point sent;
+  // uv_async_send() has been called and the callback has not run yet
+  bool pending;
+  vector<double> samples;
+  size_t next;
+  LoopDelay();
+  void Add(high_resolution_clock::duration);
+  // In ms, 0 without samples
+  double P99() const;
+};
+
+/**
+ * The run queue metrics returned by JSON.schedulerStats()
+ */
+struct Statistics {
+  // Completed conversions, executed slices and converted nodes
+  uint64_t jobs, slices, nodes;
+  // The waiting time in the run queue of each slice and of each conversion
+  high_resolution_clock::duration slice_wait, slice_wait_max, job_wait, job_wait_max;
+  Statistics();
+};
+
+/**
+ * The position of toObjectStream() in an array,
+ * it keeps the document alive
+ */
+struct Cursor {
+  std::shared_ptr<parser> parser_;
+  dom::array::iterator pos, end;
+};
+
+/**
+ * The run queue order, higher priorities first,
+ * then first come, first served
+ */
+struct Order {
+  bool operator()(const std::shared_ptr<Context> &a, const std::shared_ptr<Context> &b) const {
+    return a->priority < b->priority || (a->priority == b->priority && a->seq > b->seq);
+  }
+};
+
+typedef std::priority_queue<std::shared_ptr<Context>, vector<std::shared_ptr<Context>>, Order> RunQueue;
+
 }; // namespace ToObjectAsync
 
+/**
+ * A background job that runs on the dedicated thread pool of the
+ * environment when there is one or on the libuv thread pool otherwise
+ * (a minimal Napi::AsyncWorker that supports both)
+ */
+class AsyncJob {
+public:
+  AsyncJob(Napi::Env, int priority = 0);
+  virtual ~AsyncJob();
+  void Queue();
+  Napi::Env Env() const { return env; }
+
+  // The priority option of the parse methods, higher runs first
+  static int GetPriority(Napi::Env, const Napi::Value &);
+
+protected:
+  virtual void Execute() = 0;
+  virtual void OnOK() = 0;
+  virtual void OnError(const Napi::Error &) = 0;
+  void SetError(const std::string &);
+
+private:
+  napi_env env;
+  napi_async_work work;
+  int priority;
+  uint64_t seq;
+  bool failed;
+  std::string error;
+
+  // Called in the background thread
+  void Run();
+  // Called on the main thread, deletes the job
+  void Complete();
+  friend class ThreadPool;
+};
+
+// More parsing threads than cores only add contention and scratch parsers
+inline unsigned ClampThreads(unsigned threads) {
+  unsigned cores = std::thread::hardware_concurrency();
+  return cores > 0 ? std::min(threads, cores) : threads;
+}
+
+/**
+ * The optional dedicated thread pool of an environment
+ *
+ * The jobs are ordered by priority and then by submission,
+ * the completions are delivered on the main thread through
+ * an uv_async_t
+ */
+class ThreadPool {
+  struct Order {
+    bool operator()(const AsyncJob *a, const AsyncJob *b) const {
+      return a->priority < b->priority || (a->priority == b->priority && a->seq > b->seq);
+    }
+  };
+  std::priority_queue<AsyncJob *, vector<AsyncJob *>, Order> jobs;
+  vector<AsyncJob *> completed;
+  vector<std::thread> workers;
+  // The workers that have exited after a shrink and must be joined
+  vector<std::thread::id> exited;
+  std::mutex lock;
+  std::condition_variable wakeup;
+  size_t wanted, running;
+  // Queued, running or not yet completed jobs
+  size_t active;
+  uint64_t next;
+  bool stopping;
+  uv_async_t completion;
+
+  void Work();
+  void Reap();
+  void Stop();
+  static void ProcessCompletions(uv_async_t *);
+
+public:
+  ThreadPool(uv_loop_t *, size_t);
+  ~ThreadPool();
+  void Resize(size_t);
+  size_t Size() const { return wanted; }
+  void Push(AsyncJob *);
+  // Stops the threads and closes the uv_async_t, must be called before destroying it
+  void Shutdown();
+};
+
+/**
+ * The external memory accounting of an environment, documents
+ * shared with other environments can outlive it
+ */
+struct ExternalMemory {
+  std::mutex lock;
+  int64_t pendingAdjustment;
+  ExternalMemory() : pendingAdjustment(0) {}
+};
+
 struct InstanceData {
-  queue<std::shared_ptr<ToObjectAsync::Context>> runQueue;
+  ToObjectAsync::RunQueue runQueue;
+  uint64_t runQueueSeq = 0;
+  ToObjectAsync::Statistics runQueueStats;
+  // toObjectAsync() reads the clock every runQueueCheck nodes (a power of 2),
+  // it is adapted to the measured average cost of a node in ns
+  size_t runQueueCheck = 64;
+  double runQueueNodeCost = 0;
+  // The current default time slice in ms, JSON.latency unless adaptive
+  unsigned runQueueLatency = 5;
+  ToObjectAsync::LoopDelay runQueueDelay;
   FunctionReference JSON_ctor;
+  FunctionReference Proxy_ctor;
+  // JSON.stringify() unboxes the primitive wrapper objects
+  FunctionReference Number_ctor, String_ctor, Boolean_ctor;
+  ObjectReference proxy_handler;
+  // The accessor returning the JSON behind a proxy
+  Reference<Symbol> proxy_target;
+  // The type names are created only once
+  Reference<Napi::String> type_names[JSON_TYPES];
   uv_async_t runQueueJob;
-  std::mutex lock;
-  int64_t pendingExternalMemoryAdjustment;
+  std::shared_ptr<ExternalMemory> memory;
+  // Created on the first assignment of JSON.threads
+  std::unique_ptr<ThreadPool> pool;
+  // Output buffers of JSON.stringify[Async] retained between calls
+  vector<std::string> stringifyPool;
 };
 
 namespace Napi {
@@ -111,73 +527,179 @@ namespace Napi {
 
 template <typename T, typename... ARGS>
 inline std::shared_ptr<T> MakeTracking(Env env, int64_t extra_size, ARGS &&...args) {
-  auto instance = env.GetInstanceData<InstanceData>();
+  auto memory = env.GetInstanceData<InstanceData>()->memory;
   int64_t adjust = extra_size + sizeof(T);
-  std::lock_guard guard{instance->lock};
-  instance->pendingExternalMemoryAdjustment += adjust;
-  return std::shared_ptr<T>{new T(std::forward<ARGS>(args)...), [instance, adjust](void *p) {
-                              std::lock_guard guard{instance->lock};
-                              instance->pendingExternalMemoryAdjustment -= adjust;
+  std::lock_guard guard{memory->lock};
+  memory->pendingAdjustment += adjust;
+  return std::shared_ptr<T>{new T(std::forward<ARGS>(args)...), [memory, adjust](void *p) {
+                              std::lock_guard guard{memory->lock};
+                              memory->pendingAdjustment -= adjust;
                               delete static_cast<T *>(p);
                             }};
 }
 template <typename T> inline std::shared_ptr<T> MakeTracking(Env env) {
-  auto instance = env.GetInstanceData<InstanceData>();
-  std::lock_guard guard{instance->lock};
-  instance->pendingExternalMemoryAdjustment += sizeof(T);
-  return std::shared_ptr<T>{new T, [instance](void *p) {
-                              std::lock_guard guard{instance->lock};
-                              instance->pendingExternalMemoryAdjustment -= sizeof(T);
+  auto memory = env.GetInstanceData<InstanceData>()->memory;
+  std::lock_guard guard{memory->lock};
+  memory->pendingAdjustment += sizeof(T);
+  return std::shared_ptr<T>{new T, [memory](void *p) {
+                              std::lock_guard guard{memory->lock};
+                              memory->pendingAdjustment -= sizeof(T);
                               delete static_cast<T *>(p);
                             }};
 }
 } // namespace Napi
 
+/**
+ * The base of the async workers that read a parsed document
+ * in a background thread, the context holds the document
+ * while the worker is running
+ */
+class JSONAsyncWorker : public AsyncWorker {
+protected:
+  Promise::Deferred deferred;
+  JSONElementContext context;
+
+public:
+  JSONAsyncWorker(Napi::Env env, const JSONElementContext &_context)
+      : AsyncWorker(env, "JSONAsyncWorker"), deferred(env), context(_context, _context.root) {}
+  virtual void OnError(const Napi::Error &e) override { deferred.Reject(e.Value()); }
+  Promise GetPromise() { return deferred.Promise(); }
+};
+
 /**
  * The JavaScript proxy object for a JSON element in the binary parsed
  * structure of simdjson.
  */
 class JSON : public ObjectWrap<JSON>, JSONElementContext {
   static unsigned latency;
+  static unsigned sliceNodes;
+  static unsigned targetLoopDelay;
+  // The registry entry of the document if it has been shared
+  std::string shared_token;
+  static void Unshare(const std::string &);
 
   static inline Napi::Value New(InstanceData *, const element &, ObjectStore *store, const napi_value *);
+  static inline Napi::Value NewProxy(InstanceData *, const element &, ObjectStore *store, const Napi::Value &);
 
+  static bool GetThrowOnError(const CallbackInfo &);
   static Napi::Value ToObject(Napi::Env, const element &);
-  static void ToObjectAsync(std::shared_ptr<ToObjectAsync::Context>, high_resolution_clock::time_point);
+  static Napi::Value ToObject(Napi::Env, const element &, const Query::Projection &,
+                              const Query::Projection::State &);
+  static std::shared_ptr<Query::Projection> GetProjection(Napi::Env, const Napi::Value &);
+  static std::shared_ptr<Query::Projection> GetOnly(Napi::Env, const Napi::Value &);
+  static vector<string> GetPointers(Napi::Env, const Napi::Value &, const char *);
+  static bool ToObjectAsync(std::shared_ptr<ToObjectAsync::Context>, high_resolution_clock::time_point);
+  static void Enqueue(InstanceData *, std::shared_ptr<ToObjectAsync::Context>);
+  static void ToObjectPlan(std::shared_ptr<ToObjectAsync::Context>, const element &);
+  static bool ToObjectRun(std::shared_ptr<ToObjectAsync::Context>, high_resolution_clock::time_point);
   static std::shared_ptr<padded_string> GetString(const CallbackInfo &);
-  static inline bool CanRun(const high_resolution_clock::time_point &);
+  static std::shared_ptr<padded_string> GetString(Napi::Env, const Napi::Value &);
+  static inline bool CanRun(const high_resolution_clock::time_point &, unsigned);
+  static inline bool CanRun(const high_resolution_clock::time_point &, const high_resolution_clock::time_point &,
+                            unsigned);
+  static void AdaptClockCheck(InstanceData *, size_t, high_resolution_clock::duration);
+  static void AdaptLatency(InstanceData *, const high_resolution_clock::time_point &);
+  static void WakeRunQueue(InstanceData *);
   static inline Napi::Value GetPrimitive(Napi::Env, const element &);
+  static inline JSONTypeId GetTypeId(const element &);
   Napi::Value Get(Napi::Env, bool);
+  // get(), expand() and toObject({ depth }) return the elements
+  // below a given depth as JSON elements or as proxies
+  struct Hybrid {
+    InstanceData *instance;
+    JSONElementContext context;
+    napi_value ctor_args;
+    bool proxy;
+    // The primitive values below the depth are JSON elements too
+    bool primitives;
+    Hybrid(Napi::Env, const JSONElementContext &, bool, bool);
+  };
+  Napi::Value ToObject(Napi::Env, const element &, uint32_t, Hybrid &);
+  enum SerializeMode { SERIALIZE_STRING, SERIALIZE_BUFFER };
+  static Napi::Value SerializeResult(Napi::Env, std::string &&, SerializeMode);
+  Napi::Value SerializeAsync(const CallbackInfo &, SerializeMode);
+  enum ScanMode { SCAN_FILTER, SCAN_FIND, SCAN_FIND_INDEX };
+  Napi::Value Scan(const CallbackInfo &, ScanMode);
 
 public:
   JSON(const CallbackInfo &);
   virtual ~JSON();
 
+  const JSONElementContext &GetContext() const { return *this; }
+
   static Napi::Value Parse(const CallbackInfo &);
   static Napi::Value ParseAsync(const CallbackInfo &);
+  static Napi::Value ParseManyAsync(const CallbackInfo &);
+  static Napi::Value ParseAsyncBatch(const CallbackInfo &);
+  static Napi::Value Stringify(const CallbackInfo &);
+  static Napi::Value StringifyAsync(const CallbackInfo &);
+  static Napi::Value Load(const CallbackInfo &);
+  static Napi::Value Open(const CallbackInfo &);
   Napi::Value Get(const CallbackInfo &);
   Napi::Value Expand(const CallbackInfo &);
   Napi::Value Path(const CallbackInfo &);
+  Napi::Value PathAsync(const CallbackInfo &);
+  Napi::Value QueryElements(const CallbackInfo &);
+  Napi::Value QueryElementsAsync(const CallbackInfo &);
   Napi::Value ToObject(const CallbackInfo &);
   Napi::Value ToObjectAsync(const CallbackInfo &);
+  Napi::Value ToObjectCursor(const CallbackInfo &);
+  Napi::Value ToObjectChunkAsync(const CallbackInfo &);
+  Napi::Value Filter(const CallbackInfo &);
+  Napi::Value Find(const CallbackInfo &);
+  Napi::Value FindIndex(const CallbackInfo &);
+  Napi::Value Search(const CallbackInfo &);
+  Napi::Value Save(const CallbackInfo &);
+  Napi::Value Share(const CallbackInfo &);
+  Napi::Value Aggregate(const CallbackInfo &);
+  Napi::Value AggregateAsync(const CallbackInfo &);
+  Napi::Value Serialize(const CallbackInfo &);
+  Napi::Value SerializeAsync(const CallbackInfo &);
+  Napi::Value ToBuffer(const CallbackInfo &);
+  Napi::Value ToBufferAsync(const CallbackInfo &);
+  Napi::Value ToV8Buffer(const CallbackInfo &);
+  Napi::Value ToV8BufferAsync(const CallbackInfo &);
+  Napi::Value Proxify(const CallbackInfo &);
+  Napi::Value ProxyGet(const CallbackInfo &);
+  Napi::Value ProxyHas(const CallbackInfo &);
+  Napi::Value ProxyTargetGetter(const CallbackInfo &);
   Napi::Value ToStringGetter(const CallbackInfo &);
   Napi::Value TypeGetter(const CallbackInfo &);
+  Napi::Value TypeIdGetter(const CallbackInfo &);
   static Napi::Value LatencyGetter(const CallbackInfo &);
   static void LatencySetter(const CallbackInfo &, const Napi::Value &);
+  static Napi::Value SliceNodesGetter(const CallbackInfo &);
+  static void SliceNodesSetter(const CallbackInfo &, const Napi::Value &);
+  static Napi::Value TargetLoopDelayGetter(const CallbackInfo &);
+  static void TargetLoopDelaySetter(const CallbackInfo &, const Napi::Value &);
+  static Napi::Value SchedulerStats(const CallbackInfo &);
+  static Napi::Value ThreadsGetter(const CallbackInfo &);
+  static void ThreadsSetter(const CallbackInfo &, const Napi::Value &);
+  static Napi::Value ProxyHandlerGetter(const CallbackInfo &);
+  static void ProxyHandlerSetter(const CallbackInfo &, const Napi::Value &);
   static Napi::Value SIMDGetter(const CallbackInfo &);
   static Napi::Value SIMDJSONVersionGetter(const CallbackInfo &);
 
   static void ProcessRunQueue(uv_async_t *);
   static void ProcessExternalMemory(Napi::Env env);
 
-  static Function GetClass(Napi::Env env);
+  // Drops the documents shared by an environment that is being destroyed
+  static void UnshareAll(InstanceData *);
+
+  static Function GetClass(Napi::Env env, const Object &internal);
 };
 
-inline bool JSON::CanRun(const high_resolution_clock::time_point &start) {
+inline bool JSON::CanRun(const high_resolution_clock::time_point &start, unsigned budget) {
+  return CanRun(start, high_resolution_clock::now(), budget);
+}
+
+// When the current time is already known
+inline bool JSON::CanRun(const high_resolution_clock::time_point &start, const high_resolution_clock::time_point &now,
+                         unsigned budget) {
 #ifdef DEBUG_VERBOSE
   return true;
 #else
-  return duration_cast<milliseconds>(high_resolution_clock::now() - start).count() < latency;
+  return duration_cast<milliseconds>(now - start).count() < budget;
 #endif
 }
 
@@ -199,4 +721,12 @@ Napi::Value JSON::New(InstanceData *instance, const element &el, ObjectStore *st
   store->emplace(el, Weak(r.As<Object>()));
   return r;
 }
+
+Napi::Value JSON::NewProxy(InstanceData *instance, const element &el, ObjectStore *store, const Napi::Value &target) {
+  TRY_RETURN_FROM_STORE(store, el);
+  Napi::Value r;
+  r = instance->Proxy_ctor.Value().New({target, instance->proxy_handler.Value()});
+  store->emplace(el, Weak(r.As<Object>()));
+  return r;
+}
 #endif
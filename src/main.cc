@@ -1,21 +1,66 @@
 #include "jsonAsync.h"
 #include <node_api.h>
 
-Function JSON::GetClass(Napi::Env env) {
+// The helpers used only by lib/index.cjs are keyed by the symbols in internal
+Function JSON::GetClass(Napi::Env env, const Object &internal) {
+  auto types = Array::New(env, JSON_TYPES);
+  for (size_t i = 0; i < JSON_TYPES; i++)
+    types.Set(i, String::New(env, JSONTypeNames[i]));
+  types.Freeze();
+
   return DefineClass(env, "JSON",
                      {
                          JSON::InstanceAccessor<&JSON::TypeGetter>("type"),
+                         JSON::InstanceAccessor<&JSON::TypeIdGetter>("typeId"),
                          JSON::InstanceAccessor<&JSON::ToStringGetter>(Symbol::WellKnown(env, "toStringTag")),
                          JSON::InstanceMethod<&JSON::Get>("get"),
                          JSON::InstanceMethod<&JSON::Expand>("expand"),
                          JSON::InstanceMethod<&JSON::Path>("path"),
+                         JSON::InstanceMethod<&JSON::PathAsync>("pathAsync"),
+                         JSON::InstanceMethod<&JSON::QueryElements>("query"),
+                         JSON::InstanceMethod<&JSON::QueryElementsAsync>("queryAsync"),
                          JSON::InstanceMethod<&JSON::ToObject>("toObject"),
                          JSON::InstanceMethod<&JSON::ToObjectAsync>("toObjectAsync"),
+                         JSON::InstanceMethod<&JSON::ToObjectCursor>(internal.Get("toObjectCursor").As<Symbol>()),
+                         JSON::InstanceMethod<&JSON::ToObjectChunkAsync>(
+                             internal.Get("toObjectChunkAsync").As<Symbol>()),
+                         JSON::InstanceMethod<&JSON::Filter>("filter"),
+                         JSON::InstanceMethod<&JSON::Find>("find"),
+                         JSON::InstanceMethod<&JSON::FindIndex>("findIndex"),
+                         JSON::InstanceMethod<&JSON::Search>("search"),
+                         JSON::InstanceMethod<&JSON::Aggregate>("aggregate"),
+                         JSON::InstanceMethod<&JSON::AggregateAsync>("aggregateAsync"),
+                         JSON::InstanceMethod<&JSON::Serialize>("stringify"),
+                         JSON::InstanceMethod<&JSON::SerializeAsync>("stringifyAsync"),
+                         JSON::InstanceMethod<&JSON::ToBuffer>("toBuffer"),
+                         JSON::InstanceMethod<&JSON::ToBufferAsync>("toBufferAsync"),
+                         JSON::InstanceMethod<&JSON::ToV8Buffer>("toV8Buffer"),
+                         JSON::InstanceMethod<&JSON::ToV8BufferAsync>("toV8BufferAsync"),
+                         JSON::InstanceMethod<&JSON::Save>("save"),
+                         JSON::InstanceMethod<&JSON::Share>("share"),
+                         JSON::InstanceMethod<&JSON::Proxify>("proxify"),
+                         JSON::InstanceMethod<&JSON::ProxyGet>(internal.Get("proxyGet").As<Symbol>()),
+                         JSON::InstanceMethod<&JSON::ProxyHas>(internal.Get("proxyHas").As<Symbol>()),
+                         JSON::InstanceAccessor<&JSON::ProxyTargetGetter>(internal.Get("proxyTarget").As<Symbol>()),
                          JSON::StaticMethod<&JSON::Parse>("parse"),
                          JSON::StaticMethod<&JSON::ParseAsync>("parseAsync"),
+                         JSON::StaticMethod<&JSON::ParseManyAsync>("parseManyAsync"),
+                         JSON::StaticMethod<&JSON::ParseAsyncBatch>("parseAsyncBatch"),
+                         JSON::StaticMethod<&JSON::Stringify>("stringify"),
+                         JSON::StaticMethod<&JSON::StringifyAsync>("stringifyAsync"),
+                         JSON::StaticMethod<&JSON::Load>("load"),
+                         JSON::StaticMethod<&JSON::Open>("open"),
+                         JSON::StaticMethod<&JSON::SchedulerStats>("schedulerStats"),
                          JSON::StaticAccessor<&JSON::LatencyGetter, &JSON::LatencySetter>("latency"),
+                         JSON::StaticAccessor<&JSON::SliceNodesGetter, &JSON::SliceNodesSetter>("sliceNodes"),
+                         JSON::StaticAccessor<&JSON::TargetLoopDelayGetter, &JSON::TargetLoopDelaySetter>(
+                             "targetLoopDelay"),
+                         JSON::StaticAccessor<&JSON::ThreadsGetter, &JSON::ThreadsSetter>("threads"),
+                         JSON::StaticAccessor<&JSON::ProxyHandlerGetter, &JSON::ProxyHandlerSetter>(
+                             internal.Get("proxyHandler").As<Symbol>()),
                          JSON::StaticAccessor<&JSON::SIMDJSONVersionGetter>("simdjson_version"),
                          JSON::StaticAccessor<&JSON::SIMDGetter>("simd"),
+                         JSON::StaticValue("types", types),
 #ifdef DEBUG
                          JSON::StaticValue("debug", Boolean::New(env, true)),
 #endif
@@ -23,12 +68,24 @@ Function JSON::GetClass(Napi::Env env) {
 }
 
 Object Init(Napi::Env env, Object exports) {
-  Function JSON_ctor = JSON::GetClass(env);
+  // lib/index.cjs removes them from the exports
+  auto internal = Object::New(env);
+  for (auto name : {"proxyGet", "proxyHas", "proxyTarget", "proxyHandler", "toObjectCursor", "toObjectChunkAsync"})
+    internal.Set(name, Symbol::New(env, name));
+  Function JSON_ctor = JSON::GetClass(env, internal);
   exports.Set("JSON", JSON_ctor);
+  exports.Set("internal", internal);
 
   auto instance = new InstanceData;
-  instance->pendingExternalMemoryAdjustment = 0;
+  instance->memory = std::make_shared<ExternalMemory>();
   instance->JSON_ctor = Persistent(JSON_ctor);
+  instance->Proxy_ctor = Persistent(env.Global().Get("Proxy").As<Function>());
+  instance->proxy_target = Persistent(internal.Get("proxyTarget").As<Symbol>());
+  instance->Number_ctor = Persistent(env.Global().Get("Number").As<Function>());
+  instance->String_ctor = Persistent(env.Global().Get("String").As<Function>());
+  instance->Boolean_ctor = Persistent(env.Global().Get("Boolean").As<Function>());
+  for (size_t i = 0; i < JSON_TYPES; i++)
+    instance->type_names[i] = Persistent(String::New(env, JSONTypeNames[i]));
   env.SetInstanceData(instance);
 
 #ifdef DEBUG
@@ -50,6 +107,10 @@ Object Init(Napi::Env env, Object exports) {
 #ifdef DEBUG
         cerr << "everything-json environment cleanup: " << instance << endl;
 #endif
+        // Closed before runQueueJob, its close callback is the last one
+        if (instance->pool)
+          instance->pool->Shutdown();
+        JSON::UnshareAll(instance);
         instance->runQueueJob.data = hook;
         uv_close(reinterpret_cast<uv_handle_t *>(&instance->runQueueJob), [](uv_handle_t *handle) {
           auto hook = static_cast<napi_async_cleanup_hook_handle>(handle->data);
@@ -62,6 +123,14 @@ Object Init(Napi::Env env, Object exports) {
           }
         });
         instance->JSON_ctor.Reset();
+        instance->Proxy_ctor.Reset();
+        instance->Number_ctor.Reset();
+        instance->String_ctor.Reset();
+        instance->Boolean_ctor.Reset();
+        instance->proxy_handler.Reset();
+        instance->proxy_target.Reset();
+        for (auto &name : instance->type_names)
+          name.Reset();
       },
       instance, nullptr);
   if (r != napi_ok) {
@@ -1,22 +1,351 @@
 #include "jsonAsync.h"
+#include <cstring>
+#include <thread>
+
+// Smaller documents are always parsed by a single thread
+static constexpr size_t parallel_min_size = 1024 * 1024;
+
+namespace {
+
+inline bool IsWhitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+// Returns the position after the closing quote of a string, p is after the opening quote
+const char *SkipString(const char *p, const char *end) {
+  while (p < end) {
+    p = static_cast<const char *>(memchr(p, '"', end - p));
+    if (p == nullptr)
+      return end;
+    // The quote is escaped by an odd number of backslashes,
+    // the opening quote stops the count
+    size_t backslashes = 0;
+    while (p[-1 - backslashes] == '\\')
+      backslashes++;
+    p++;
+    if (backslashes % 2 == 0)
+      return p;
+  }
+  return end;
+}
+
+// Returns the next ',' or closing bracket that is not inside a string or a nested container
+const char *NextSeparator(const char *p, const char *end) {
+  size_t depth = 0;
+  while (p < end) {
+    switch (*p) {
+    case '"':
+      p = SkipString(p + 1, end);
+      continue;
+    case '[':
+    case '{':
+      depth++;
+      break;
+    case ']':
+    case '}':
+      if (depth == 0)
+        return p;
+      depth--;
+      break;
+    case ',':
+      if (depth == 0)
+        return p;
+      break;
+    }
+    p++;
+  }
+  return end;
+}
+
+/**
+ * A top-level array parsed in multiple threads
+ *
+ * The parse job splits the text of the array into one chunk per thread
+ * with a byte scan that only tracks the strings and the nesting depth,
+ * cutting after the first top-level ',' past each k / threads of the
+ * text. Then it requests helper jobs on its pool through a thread-safe
+ * function. The chunks are claimed by the job and by the helpers, each
+ * participant parses the elements of its chunks one by one with its own
+ * scratch parser and appends their tapes to the chunk. The job finally
+ * merges the chunks into one document under a common root.
+ *
+ * The job never waits for a chunk that has not been claimed, the
+ * helpers only speed it up when there are idle threads in the pool.
+ */
+class ParallelParse : public std::enable_shared_from_this<ParallelParse> {
+  struct Chunk {
+    const char *begin, *end;
+    size_t count;
+    vector<uint64_t> tape;
+    vector<uint8_t> strings;
+    std::string error;
+  };
+
+  unsigned threads;
+  int priority;
+  vector<Chunk> chunks;
+  std::mutex lock;
+  std::condition_variable wakeup;
+  size_t claimed, finished;
+  // Queues the helpers on the main thread
+  napi_threadsafe_function request;
+
+  static void QueueHelpers(napi_env, napi_value, void *, void *);
+  bool Split(const padded_string &);
+  void ParseChunk(Chunk &);
+  void Participate();
+
+public:
+  ParallelParse(Napi::Env, unsigned threads, int priority);
+  ~ParallelParse();
+
+  // Returns false if the text is not an array with enough elements
+  bool Parse(const padded_string &, document &);
+  // Releases the thread-safe function if the job does not reach Parse()
+  void Close();
+  // Called by the helper jobs
+  void Help() { Participate(); }
+};
+
+ParallelParse::ParallelParse(Napi::Env env, unsigned _threads, int _priority)
+    : threads(_threads), priority(_priority), claimed(0), finished(0), request(nullptr) {
+  napi_value name;
+  napi_create_string_utf8(env, "JSONParallelParse", NAPI_AUTO_LENGTH, &name);
+  if (napi_create_threadsafe_function(env, nullptr, nullptr, name, 0, 1, nullptr, nullptr, nullptr, QueueHelpers,
+                                      &request) != napi_ok) {
+    throw Error::New(env, "Failed creating a thread-safe function");
+  }
+}
+
+ParallelParse::~ParallelParse() { Close(); }
+
+void ParallelParse::Close() {
+  if (request == nullptr)
+    return;
+  napi_release_threadsafe_function(request, napi_tsfn_release);
+  request = nullptr;
+}
+
+bool ParallelParse::Split(const padded_string &json_text) {
+  const char *p = json_text.data(), *end = json_text.data() + json_text.length();
+  while (p < end && IsWhitespace(*p))
+    p++;
+  while (end > p && IsWhitespace(end[-1]))
+    end--;
+  // Everything else is left to the single-threaded parser and its errors
+  if (end - p < 2 || *p != '[' || end[-1] != ']')
+    return false;
+  const char *first = p + 1, *last = end - 1;
+
+  size_t total = last - first;
+  vector<const char *> starts{first};
+  const char *target = first + total / threads;
+  for (const char *q = first; q < last && starts.size() < threads; q++) {
+    q = NextSeparator(q, last);
+    if (q == last)
+      break;
+    if (*q != ',')
+      throw simdjson_error(TAPE_ERROR);
+    if (q >= target) {
+      starts.push_back(q + 1);
+      target = first + total * starts.size() / threads;
+    }
+  }
+  if (starts.size() < 2)
+    return false;
+
+  chunks.resize(starts.size());
+  for (size_t k = 0; k < chunks.size(); k++) {
+    chunks[k].begin = starts[k];
+    // Without the ',' before the next chunk
+    chunks[k].end = k + 1 < chunks.size() ? starts[k + 1] - 1 : last;
+    chunks[k].count = 0;
+  }
+  return true;
+}
+
+void ParallelParse::ParseChunk(Chunk &chunk) {
+  try {
+    parser scratch;
+    for (const char *p = chunk.begin;; p++) {
+      const char *q = NextSeparator(p, chunk.end);
+      if (q < chunk.end && *q != ',')
+        throw simdjson_error(TAPE_ERROR);
+      // The text after each element is readable up to the padding of the whole input
+      auto r = scratch.parse(p, q - p, false);
+      if (r.error() != SUCCESS)
+        throw simdjson_error(r.error());
+      // Skip the root words
+      size_t len = Tape::Length(scratch.doc);
+      size_t strings = Tape::StringsLength(scratch.doc);
+      size_t index = chunk.tape.size();
+      chunk.tape.resize(index + len - 2);
+      Tape::Relocate(chunk.tape.data(), index, scratch.doc.tape.get(), 1, len - 1, chunk.strings.size());
+      chunk.strings.insert(chunk.strings.end(), scratch.doc.string_buf.get(), scratch.doc.string_buf.get() + strings);
+      chunk.count++;
+      if (q == chunk.end)
+        break;
+      p = q;
+    }
+  } catch (const exception &err) {
+    chunk.error = err.what();
+  }
+}
+
+void ParallelParse::Participate() {
+  std::unique_lock guard{lock};
+  while (claimed < chunks.size()) {
+    Chunk &chunk = chunks[claimed++];
+    guard.unlock();
+    ParseChunk(chunk);
+    guard.lock();
+    if (++finished == chunks.size())
+      wakeup.notify_all();
+  }
+}
+
+bool ParallelParse::Parse(const padded_string &json_text, document &doc) {
+  bool split;
+  try {
+    split = Split(json_text);
+  } catch (...) {
+    Close();
+    throw;
+  }
+  if (!split) {
+    Close();
+    return false;
+  }
+
+  // The helpers are queued only now that there are chunks to claim
+  auto self = new std::shared_ptr<ParallelParse>(shared_from_this());
+  if (napi_call_threadsafe_function(request, self, napi_tsfn_nonblocking) != napi_ok)
+    delete self;
+  Close();
+
+  Participate();
+  {
+    std::unique_lock guard{lock};
+    wakeup.wait(guard, [this]() { return finished == chunks.size(); });
+  }
+  for (auto &chunk : chunks)
+    if (!chunk.error.empty())
+      throw std::runtime_error(chunk.error);
+
+  // root, [, the elements, ], root
+  size_t len = 4, strings_len = 0, count = 0;
+  for (auto &chunk : chunks) {
+    len += chunk.tape.size();
+    strings_len += chunk.strings.size();
+    count += chunk.count;
+  }
+  if (len >= std::numeric_limits<uint32_t>::max())
+    throw simdjson_error(CAPACITY);
+  doc.tape.reset(new uint64_t[len]);
+  doc.string_buf.reset(new uint8_t[strings_len + SIMDJSON_PADDING]);
+  auto word = [](internal::tape_type type, uint64_t payload) { return (uint64_t(type) << 56) | payload; };
+  count = std::min<uint64_t>(count, internal::JSON_COUNT_MASK);
+  doc.tape[0] = word(internal::tape_type::ROOT, len);
+  doc.tape[1] = word(internal::tape_type::START_ARRAY, (uint64_t(count) << 32) | (len - 1));
+  size_t index = 2, strings_offset = 0;
+  for (auto &chunk : chunks) {
+    Tape::Relocate(doc.tape.get(), index, chunk.tape.data(), 0, chunk.tape.size(), strings_offset);
+    if (!chunk.strings.empty())
+      memcpy(doc.string_buf.get() + strings_offset, chunk.strings.data(), chunk.strings.size());
+    index += chunk.tape.size();
+    strings_offset += chunk.strings.size();
+  }
+  doc.tape[len - 2] = word(internal::tape_type::END_ARRAY, 1);
+  doc.tape[len - 1] = word(internal::tape_type::ROOT, 0);
+  // The scratch results are not needed anymore
+  std::lock_guard guard{lock};
+  for (auto &chunk : chunks) {
+    vector<uint64_t>().swap(chunk.tape);
+    vector<uint8_t>().swap(chunk.strings);
+  }
+  return true;
+}
+
+// Parses chunks of a ParallelParse on the pool of the parse job
+class ParseHelper : public AsyncJob {
+  std::shared_ptr<ParallelParse> parallel;
+
+public:
+  ParseHelper(Napi::Env env, const std::shared_ptr<ParallelParse> &_parallel, int priority)
+      : AsyncJob(env, priority), parallel(_parallel) {}
+  virtual void Execute() override { parallel->Help(); }
+  virtual void OnOK() override {}
+  virtual void OnError(const Napi::Error &) override {}
+};
+
+// Called on the main thread, env is null when the environment is being destroyed
+void ParallelParse::QueueHelpers(napi_env env, napi_value, void *, void *data) {
+  std::unique_ptr<std::shared_ptr<ParallelParse>> self(static_cast<std::shared_ptr<ParallelParse> *>(data));
+  if (env == nullptr)
+    return;
+  try {
+    for (unsigned k = 1; k < (*self)->threads; k++) {
+      std::unique_ptr<ParseHelper> helper(new ParseHelper(env, *self, (*self)->priority));
+      helper->Queue();
+      helper.release();
+    }
+  } catch (const Napi::Error &) {
+    // The job parses the remaining chunks by itself
+  }
+}
+
+} // namespace
 
 Value JSON::ParseAsync(const CallbackInfo &info) {
-  class ParserAsyncWorker : public AsyncWorker {
+  class ParserAsyncWorker : public AsyncJob {
     Promise::Deferred deferred;
     std::shared_ptr<padded_string> json_text;
     std::shared_ptr<parser> parser_;
     std::shared_ptr<element> document;
+    std::shared_ptr<ParallelParse> parallel;
+    std::shared_ptr<Query::Projection> only;
+    Cancellation cancel;
 
-  public:
-    ParserAsyncWorker(Napi::Env env, std::shared_ptr<padded_string> text)
-        : AsyncWorker(env, "JSONAsyncWorker"), deferred(env), json_text(text) {}
-    virtual void Execute() override {
+    void Parse() {
+      // A parse aborted while it was waiting in the queue is skipped
+      if (cancel.Aborted())
+        return;
       napi_env env = Env();
+      // The input text is released as soon as the selected subtrees have been copied
+      if (only) {
+        auto compact = Query::Extract(*json_text, *only);
+        if (compact)
+          json_text = compact;
+      }
       parser_ = Napi::MakeTracking<parser>(env);
+      if (parallel && json_text->length() >= parallel_min_size && parallel->Parse(*json_text, parser_->doc)) {
+        document = Napi::MakeTracking<element>(env, json_text->length() * 2, parser_->doc.root());
+        return;
+      }
+      if (parallel)
+        parallel->Close();
       // This needs https://github.com/simdjson/simdjson/issues/1017 for optimal solution
       document = Napi::MakeTracking<element>(env, json_text->length() * 2, parser_->parse(*json_text));
     }
+
+  public:
+    ParserAsyncWorker(Napi::Env env, std::shared_ptr<padded_string> text, std::shared_ptr<ParallelParse> _parallel,
+                      std::shared_ptr<Query::Projection> _only, int priority)
+        : AsyncJob(env, priority), deferred(env), json_text(text), parallel(_parallel), only(_only) {}
+    virtual void Execute() override {
+      // The thread-safe function of the helpers keeps the event loop alive until it is released
+      try {
+        Parse();
+      } catch (...) {
+        if (parallel)
+          parallel->Close();
+        throw;
+      }
+      if (parallel)
+        parallel->Close();
+    }
     virtual void OnOK() override {
+      if (cancel.Aborted())
+        return;
+      cancel.Release();
       Napi::Env env = Env();
       auto instance = env.GetInstanceData<InstanceData>();
       element root = *document.get();
@@ -25,16 +354,49 @@ Value JSON::ParseAsync(const CallbackInfo &info) {
       auto result = New(instance, root, context.store_json.get(), &ctor_args);
       deferred.Resolve(result);
     }
-    virtual void OnError(const Napi::Error &e) override { deferred.Reject(e.Value()); }
+    virtual void OnError(const Napi::Error &e) override {
+      if (cancel.Aborted())
+        return;
+      cancel.Release();
+      deferred.Reject(e.Value());
+    }
     Promise GetPromise() { return deferred.Promise(); }
+    // Returns false if the signal is already aborted
+    bool Listen(const Napi::Value &options) {
+      cancel.Listen(Env(), options, deferred);
+      return !cancel.Aborted();
+    }
   };
 
   Napi::Env env(info.Env());
 
+  unsigned threads = 1;
+  int priority = info.Length() > 1 ? AsyncJob::GetPriority(env, info[1]) : 0;
+  if (info.Length() > 1 && !info[1].IsUndefined()) {
+    if (!info[1].IsObject()) {
+      throw TypeError::New(env, "options must be an object");
+    }
+    Napi::Value opt = info[1].As<Object>().Get("threads");
+    if (!opt.IsUndefined()) {
+      if (!opt.IsNumber() || opt.As<Number>().Int32Value() < 1) {
+        throw TypeError::New(env, "threads must be a positive number");
+      }
+      threads = ClampThreads(opt.As<Number>().Uint32Value());
+    }
+  }
+  auto only = GetOnly(env, info.Length() > 1 ? info[1] : env.Undefined());
+
   auto parser_ = Napi::MakeTracking<parser>(env);
   auto json_text = GetString(info);
-  auto worker = new ParserAsyncWorker(env, json_text);
+  std::shared_ptr<ParallelParse> parallel;
+  if (threads > 1 && json_text->length() >= parallel_min_size)
+    parallel = std::make_shared<ParallelParse>(env, threads, priority);
+  std::unique_ptr<ParserAsyncWorker> worker(new ParserAsyncWorker(env, json_text, parallel, only, priority));
+  auto promise = worker->GetPromise();
+  if (info.Length() > 1 && !worker->Listen(info[1]))
+    return promise;
 
-  worker->Queue();
-  return worker->GetPromise();
+  // The job deletes itself once completed
+  worker.release()->Queue();
+  return promise;
 }
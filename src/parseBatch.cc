@@ -0,0 +1,138 @@
+#include "jsonAsync.h"
+
+// Parsing of many small documents in as few background jobs as possible
+//
+// Each worker parses a slice of the batch with a single scratch parser
+// that keeps its internal buffers, each document is parsed into its
+// own parser so that it owns its tape.
+
+namespace {
+
+// The state shared by the workers of a batch
+struct Batch {
+  Promise::Deferred deferred;
+  Reference<Array> result;
+  size_t pending;
+  bool failed;
+  Batch(Napi::Env env, size_t len)
+      : deferred(env), result(Persistent(Array::New(env, len))), pending(0), failed(false) {}
+};
+
+} // namespace
+
+Value JSON::ParseAsyncBatch(const CallbackInfo &info) {
+  class ParseBatchAsyncWorker : public AsyncJob {
+    std::shared_ptr<Batch> batch;
+    size_t first;
+    vector<std::shared_ptr<padded_string>> texts;
+    vector<std::shared_ptr<parser>> parsers;
+    vector<std::shared_ptr<element>> documents;
+    vector<std::string> errors;
+
+    void Done() {
+      if (--batch->pending == 0 && !batch->failed) {
+        batch->deferred.Resolve(batch->result.Value());
+        batch->result.Reset();
+      }
+    }
+
+  public:
+    ParseBatchAsyncWorker(Napi::Env env, std::shared_ptr<Batch> _batch, size_t _first,
+                          vector<std::shared_ptr<padded_string>> &&_texts, int priority)
+        : AsyncJob(env, priority), batch(_batch), first(_first), texts(std::move(_texts)),
+          parsers(texts.size()), documents(texts.size()), errors(texts.size()) {}
+    virtual void Execute() override {
+      napi_env env = Env();
+      parser scratch;
+      for (size_t i = 0; i < texts.size(); i++) {
+        auto parser_ = Napi::MakeTracking<parser>(env);
+        auto r = scratch.parse_into_document(parser_->doc, *texts[i]);
+        if (r.error() != SUCCESS) {
+          errors[i] = error_message(r.error());
+        } else {
+          parsers[i] = parser_;
+          documents[i] = Napi::MakeTracking<element>(env, texts[i]->length() * 2, r.value_unsafe());
+        }
+        // The documents do not need the input text once parsed
+        texts[i].reset();
+      }
+    }
+    virtual void OnOK() override {
+      Napi::Env env = Env();
+      auto instance = env.GetInstanceData<InstanceData>();
+      if (!batch->failed) {
+        auto result = batch->result.Value();
+        for (size_t i = 0; i < documents.size(); i++) {
+          if (!documents[i]) {
+            result.Set(first + i, Error::New(env, errors[i]).Value());
+            continue;
+          }
+          element root = *documents[i].get();
+          JSONElementContext context(env, nullptr, parsers[i], documents[i], root);
+          napi_value ctor_args = External<JSONElementContext>::New(env, &context);
+          result.Set(first + i, New(instance, root, context.store_json.get(), &ctor_args));
+        }
+      }
+      Done();
+    }
+    virtual void OnError(const Napi::Error &e) override {
+      if (!batch->failed) {
+        batch->failed = true;
+        batch->deferred.Reject(e.Value());
+        batch->result.Reset();
+      }
+      Done();
+    }
+  };
+
+  Napi::Env env(info.Env());
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    throw TypeError::New(env, "JSON.parseAsyncBatch expects an array of strings or Buffers");
+  }
+  size_t workers = 1;
+  int priority = info.Length() > 1 ? AsyncJob::GetPriority(env, info[1]) : 0;
+  if (info.Length() > 1 && !info[1].IsUndefined()) {
+    if (!info[1].IsObject()) {
+      throw TypeError::New(env, "options must be an object");
+    }
+    Napi::Value opt = info[1].As<Object>().Get("threads");
+    if (!opt.IsUndefined()) {
+      if (!opt.IsNumber() || opt.As<Number>().Int32Value() < 1) {
+        throw TypeError::New(env, "threads must be a positive number");
+      }
+      workers = ClampThreads(opt.As<Number>().Uint32Value());
+    }
+  }
+
+  auto list = info[0].As<Array>();
+  size_t len = list.Length();
+  vector<std::shared_ptr<padded_string>> texts;
+  texts.reserve(len);
+  for (size_t i = 0; i < len; i++) {
+    Napi::Value text = list.Get(i);
+    if (!text.IsString() && !text.IsBuffer()) {
+      throw TypeError::New(env, "JSON.parseAsyncBatch expects an array of strings or Buffers");
+    }
+    texts.push_back(GetString(env, text));
+  }
+
+  auto batch = std::make_shared<Batch>(env, len);
+  auto promise = batch->deferred.Promise();
+  if (len == 0) {
+    batch->deferred.Resolve(batch->result.Value());
+    return promise;
+  }
+
+  workers = std::min(workers, len);
+  batch->pending = workers;
+  for (size_t k = 0; k < workers; k++) {
+    size_t first = len * k / workers;
+    size_t last = len * (k + 1) / workers;
+    vector<std::shared_ptr<padded_string>> slice(std::make_move_iterator(texts.begin() + first),
+                                                 std::make_move_iterator(texts.begin() + last));
+    auto worker = new ParseBatchAsyncWorker(env, batch, first, std::move(slice), priority);
+    worker->Queue();
+  }
+  return promise;
+}
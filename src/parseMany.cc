@@ -0,0 +1,76 @@
+#include "jsonAsync.h"
+#include <cstring>
+
+// Parsing of newline-delimited JSON (JSON Lines)
+//
+// Each line is parsed into its own document by a single scratch
+// parser that keeps its internal buffers between the lines.
+
+static inline bool IsBlank(const char *p, size_t len) {
+  for (size_t i = 0; i < len; i++)
+    if (p[i] != ' ' && p[i] != '\t' && p[i] != '\r')
+      return false;
+  return true;
+}
+
+Value JSON::ParseManyAsync(const CallbackInfo &info) {
+  class ParseManyAsyncWorker : public AsyncJob {
+    Promise::Deferred deferred;
+    std::shared_ptr<padded_string> json_text;
+    vector<std::pair<std::shared_ptr<parser>, std::shared_ptr<element>>> documents;
+
+  public:
+    ParseManyAsyncWorker(Napi::Env env, std::shared_ptr<padded_string> text, int priority)
+        : AsyncJob(env, priority), deferred(env), json_text(text) {}
+    virtual void Execute() override {
+      napi_env env = Env();
+      parser scratch;
+      const char *p = json_text->data();
+      const char *end = p + json_text->length();
+      size_t line = 1;
+      while (p < end) {
+        auto eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (eol == nullptr)
+          eol = end;
+        size_t len = eol - p;
+        if (!IsBlank(p, len)) {
+          // The document owns its tape, the input is padded for all lines
+          auto parser_ = Napi::MakeTracking<parser>(env);
+          auto r = scratch.parse_into_document(parser_->doc, p, len, false);
+          if (r.error() != SUCCESS) {
+            SetError("line " + to_string(line) + ": " + error_message(r.error()));
+            return;
+          }
+          documents.emplace_back(parser_, Napi::MakeTracking<element>(env, len * 2, r.value_unsafe()));
+        }
+        p = eol + 1;
+        line++;
+      }
+      // The documents do not need the input text once parsed
+      json_text.reset();
+    }
+    virtual void OnOK() override {
+      Napi::Env env = Env();
+      auto instance = env.GetInstanceData<InstanceData>();
+      auto result = Array::New(env, documents.size());
+      for (size_t i = 0; i < documents.size(); i++) {
+        element root = *documents[i].second.get();
+        JSONElementContext context(env, nullptr, documents[i].first, documents[i].second, root);
+        napi_value ctor_args = External<JSONElementContext>::New(env, &context);
+        result.Set(i, New(instance, root, context.store_json.get(), &ctor_args));
+      }
+      deferred.Resolve(result);
+    }
+    virtual void OnError(const Napi::Error &e) override { deferred.Reject(e.Value()); }
+    Promise GetPromise() { return deferred.Promise(); }
+  };
+
+  Napi::Env env(info.Env());
+
+  auto json_text = GetString(info);
+  int priority = info.Length() > 1 ? AsyncJob::GetPriority(env, info[1]) : 0;
+  auto worker = new ParseManyAsyncWorker(env, json_text, priority);
+
+  worker->Queue();
+  return worker->GetPromise();
+}
@@ -0,0 +1,111 @@
+#include "jsonAsync.h"
+
+// Pointer lookups that can run in a background thread, only
+// the final elements are wrapped on the main thread
+
+Value JSON::PathAsync(const CallbackInfo &info) {
+  class PathAsyncWorker : public JSONAsyncWorker {
+    string path;
+    bool throwOnError;
+    bool found;
+    element result;
+
+  public:
+    PathAsyncWorker(Napi::Env env, const JSONElementContext &_context, const string &_path, bool _throwOnError)
+        : JSONAsyncWorker(env, _context), path(_path), throwOnError(_throwOnError), found(false) {}
+    virtual void Execute() override {
+      auto r = context.root.at_pointer(path);
+      if (r.error() != SUCCESS) {
+        if (throwOnError)
+          SetError(error_message(r.error()));
+        return;
+      }
+      result = r.value_unsafe();
+      found = true;
+    }
+    virtual void OnOK() override {
+      Napi::Env env = Env();
+      if (!found) {
+        deferred.Resolve(env.Undefined());
+        return;
+      }
+      JSONElementContext result_context(context, result);
+      napi_value ctor_args = External<JSONElementContext>::New(env, &result_context);
+      deferred.Resolve(New(env.GetInstanceData<InstanceData>(), result, context.store_json.get(), &ctor_args));
+    }
+  };
+
+  Napi::Env env(info.Env());
+  bool throwOnError = GetThrowOnError(info);
+
+  auto worker = new PathAsyncWorker(env, *this, info[0].As<String>().Utf8Value(), throwOnError);
+  worker->Queue();
+  return worker->GetPromise();
+}
+
+Value JSON::QueryElements(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    throw TypeError::New(env, "No RFC6901 path given");
+  }
+
+  try {
+    auto pattern = Query::Parse(info[0].As<String>().Utf8Value());
+
+    JSONElementContext context(*this);
+    napi_value ctor_args = External<JSONElementContext>::New(env, &context);
+    auto result = Array::New(env);
+    size_t found = 0;
+    Query::Walk(root, pattern, 0, [&](const element &el) {
+      context.root = el;
+      result.Set(found++, New(instance, el, store_json.get(), &ctor_args));
+    });
+    return result;
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
+
+Value JSON::QueryElementsAsync(const CallbackInfo &info) {
+  class QueryAsyncWorker : public JSONAsyncWorker {
+    Query::Pattern pattern;
+    vector<element> results;
+
+  public:
+    QueryAsyncWorker(Napi::Env env, const JSONElementContext &_context, const string &pointer)
+        : JSONAsyncWorker(env, _context), pattern(Query::Parse(pointer)) {}
+    virtual void Execute() override {
+      Query::Walk(context.root, pattern, 0, [this](const element &el) { results.push_back(el); });
+    }
+    virtual void OnOK() override {
+      Napi::Env env = Env();
+      auto instance = env.GetInstanceData<InstanceData>();
+      JSONElementContext result_context(context, context.root);
+      napi_value ctor_args = External<JSONElementContext>::New(env, &result_context);
+      auto result = Array::New(env, results.size());
+      for (size_t i = 0; i < results.size(); i++) {
+        result_context.root = results[i];
+        result.Set(i, New(instance, results[i], context.store_json.get(), &ctor_args));
+      }
+      deferred.Resolve(result);
+    }
+  };
+
+  Napi::Env env(info.Env());
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    throw TypeError::New(env, "No RFC6901 path given");
+  }
+
+  QueryAsyncWorker *worker;
+  try {
+    worker = new QueryAsyncWorker(env, *this, info[0].As<String>().Utf8Value());
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+
+  worker->Queue();
+  return worker->GetPromise();
+}
@@ -0,0 +1,240 @@
+#include "jsonAsync.h"
+#include <algorithm>
+
+// Background jobs and the optional dedicated thread pool
+//
+// By default the jobs run on the libuv thread pool which is shared
+// with fs, dns and crypto, once JSON.threads is set, they run on
+// a dedicated pool of this environment
+
+AsyncJob::AsyncJob(Napi::Env _env, int _priority)
+    : env(_env), work(nullptr), priority(_priority), seq(0), failed(false) {}
+
+AsyncJob::~AsyncJob() {
+  if (work != nullptr)
+    napi_delete_async_work(env, work);
+}
+
+void AsyncJob::SetError(const std::string &_error) {
+  failed = true;
+  error = _error;
+}
+
+int AsyncJob::GetPriority(Napi::Env env, const Napi::Value &options) {
+  if (options.IsUndefined())
+    return 0;
+  if (!options.IsObject()) {
+    throw TypeError::New(env, "options must be an object");
+  }
+  Napi::Value priority = options.As<Object>().Get("priority");
+  if (priority.IsUndefined())
+    return 0;
+  if (!priority.IsNumber()) {
+    throw TypeError::New(env, "priority must be a number");
+  }
+  return priority.As<Number>().Int32Value();
+}
+
+void AsyncJob::Queue() {
+  auto instance = Napi::Env(env).GetInstanceData<InstanceData>();
+  if (instance->pool && instance->pool->Size() > 0) {
+    instance->pool->Push(this);
+    return;
+  }
+
+  napi_value resource_name;
+  napi_create_string_utf8(env, "JSONAsyncWorker", NAPI_AUTO_LENGTH, &resource_name);
+  napi_status r = napi_create_async_work(
+      env, nullptr, resource_name, [](napi_env, void *data) { static_cast<AsyncJob *>(data)->Run(); },
+      [](napi_env, napi_status status, void *data) {
+        auto job = static_cast<AsyncJob *>(data);
+        if (status != napi_ok)
+          job->SetError("Background job cancelled");
+        job->Complete();
+      },
+      this, &work);
+  if (r != napi_ok || napi_queue_async_work(env, work) != napi_ok) {
+    throw Error::New(env, "Failed queueing a background job");
+  }
+}
+
+void AsyncJob::Run() {
+  try {
+    Execute();
+  } catch (const exception &err) {
+    SetError(err.what());
+  }
+}
+
+void AsyncJob::Complete() {
+  Napi::Env _env(env);
+  HandleScope scope(_env);
+  try {
+    if (failed)
+      OnError(Error::New(_env, error));
+    else
+      OnOK();
+  } catch (const Error &e) {
+    // Reported as an uncaught exception instead of being left pending,
+    // the other jobs of ProcessCompletions() must still be completed
+    napi_fatal_exception(env, e.Value());
+  }
+  bool pending;
+  if (napi_is_exception_pending(env, &pending) == napi_ok && pending) {
+    napi_value error;
+    napi_get_and_clear_last_exception(env, &error);
+    napi_fatal_exception(env, error);
+  }
+  delete this;
+}
+
+ThreadPool::ThreadPool(uv_loop_t *loop, size_t threads)
+    : wanted(0), running(0), active(0), next(0), stopping(false) {
+  uv_async_init(loop, &completion, ProcessCompletions);
+  completion.data = this;
+  uv_unref(reinterpret_cast<uv_handle_t *>(&completion));
+  Resize(threads);
+}
+
+ThreadPool::~ThreadPool() { Stop(); }
+
+void ThreadPool::Resize(size_t threads) {
+  std::lock_guard guard{lock};
+  Reap();
+  wanted = threads;
+  while (running < wanted) {
+    workers.emplace_back(&ThreadPool::Work, this);
+    running++;
+  }
+  wakeup.notify_all();
+}
+
+void ThreadPool::Push(AsyncJob *job) {
+  std::lock_guard guard{lock};
+  job->seq = next++;
+  jobs.push(job);
+  // Do not allow the Node.js process to exit while there are jobs
+  if (active++ == 0)
+    uv_ref(reinterpret_cast<uv_handle_t *>(&completion));
+  wakeup.notify_one();
+}
+
+void ThreadPool::Work() {
+  std::unique_lock guard{lock};
+  while (true) {
+    wakeup.wait(guard, [this]() { return stopping || running > wanted || !jobs.empty(); });
+    // A pool that is shrunk to 0 threads drains its queue before exiting
+    if (stopping || (running > wanted && (wanted > 0 || jobs.empty()))) {
+      running--;
+      // Stop() joins all workers, otherwise the main thread does it
+      if (!stopping) {
+        exited.push_back(std::this_thread::get_id());
+        uv_async_send(&completion);
+      }
+      return;
+    }
+    AsyncJob *job = jobs.top();
+    jobs.pop();
+    guard.unlock();
+    job->Run();
+    guard.lock();
+    completed.push_back(job);
+    uv_async_send(&completion);
+  }
+}
+
+// Must be called with the lock held, the exited workers do not need it anymore
+void ThreadPool::Reap() {
+  for (auto id : exited) {
+    auto worker = std::find_if(workers.begin(), workers.end(), [id](const std::thread &t) { return t.get_id() == id; });
+    worker->join();
+    workers.erase(worker);
+  }
+  exited.clear();
+}
+
+void ThreadPool::ProcessCompletions(uv_async_t *handle) {
+  auto pool = static_cast<ThreadPool *>(handle->data);
+  vector<AsyncJob *> done;
+  {
+    std::lock_guard guard{pool->lock};
+    pool->Reap();
+    done.swap(pool->completed);
+    pool->active -= done.size();
+    if (pool->active == 0)
+      uv_unref(reinterpret_cast<uv_handle_t *>(handle));
+  }
+  if (done.empty())
+    return;
+
+  // The promises are resolved in a callback scope so that
+  // the micro tasks run when it is closed
+  napi_env env = done.front()->env;
+  HandleScope scope(env);
+  napi_value resource, resource_name;
+  napi_async_context context;
+  napi_callback_scope callback_scope;
+  napi_create_object(env, &resource);
+  napi_create_string_utf8(env, "JSONAsyncWorker", NAPI_AUTO_LENGTH, &resource_name);
+  napi_async_init(env, resource, resource_name, &context);
+  napi_open_callback_scope(env, resource, context, &callback_scope);
+  for (auto job : done)
+    job->Complete();
+  napi_close_callback_scope(env, callback_scope);
+  napi_async_destroy(env, context);
+}
+
+void ThreadPool::Stop() {
+  {
+    std::lock_guard guard{lock};
+    if (stopping)
+      return;
+    stopping = true;
+    wakeup.notify_all();
+  }
+  for (auto &worker : workers)
+    if (worker.joinable())
+      worker.join();
+
+  // The jobs that will never run or complete
+  std::lock_guard guard{lock};
+  workers.clear();
+  exited.clear();
+  while (!jobs.empty()) {
+    delete jobs.top();
+    jobs.pop();
+  }
+  for (auto job : completed)
+    delete job;
+  completed.clear();
+  active = 0;
+}
+
+void ThreadPool::Shutdown() {
+  Stop();
+  uv_close(reinterpret_cast<uv_handle_t *>(&completion), nullptr);
+}
+
+Value JSON::ThreadsGetter(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+  return Number::New(env, instance->pool ? instance->pool->Size() : 0);
+}
+
+void JSON::ThreadsSetter(const CallbackInfo &info, const Napi::Value &val) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+  if (!val.IsNumber() || val.As<Number>().Int32Value() < 0)
+    throw TypeError::New(env, "Invalid value, must be a number of threads, 0 for the libuv thread pool");
+  size_t threads = ClampThreads(val.As<Number>().Uint32Value());
+
+  if (instance->pool) {
+    instance->pool->Resize(threads);
+  } else if (threads > 0) {
+    uv_loop_t *loop;
+    if (napi_get_uv_event_loop(env, &loop) != napi_ok) {
+      throw Error::New(env, "Failed getting event loop");
+    }
+    instance->pool = std::make_unique<ThreadPool>(loop, threads);
+  }
+}
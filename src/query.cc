@@ -0,0 +1,199 @@
+#include "jsonAsync.h"
+#include <charconv>
+
+namespace Query {
+
+Pattern Parse(const string &pointer) {
+  Pattern pattern;
+  string current;
+
+  if (!pointer.empty() && pointer[0] != '/') {
+    throw simdjson_error(INVALID_JSON_POINTER);
+  }
+
+  size_t pos = 0;
+  while (pos < pointer.size()) {
+    size_t next = pointer.find('/', pos + 1);
+    if (next == string::npos)
+      next = pointer.size();
+    if (next - pos == 2 && pointer[pos + 1] == '*') {
+      pattern.push_back(current);
+      current.clear();
+    } else {
+      current.append(pointer, pos, next - pos);
+    }
+    pos = next;
+  }
+  pattern.push_back(current);
+
+  return pattern;
+}
+
+Statistics::Statistics()
+    : count(0), sum(0), min(numeric_limits<double>::infinity()), max(-numeric_limits<double>::infinity()) {}
+
+Napi::Value Statistics::ToObject(Napi::Env env, unsigned ops) const {
+  auto result = Object::New(env);
+  auto number_or_null = [env, this](double value) -> Napi::Value {
+    if (count == 0)
+      return env.Null();
+    return Number::New(env, value);
+  };
+
+  if (ops & SUM)
+    result.Set("sum", Number::New(env, sum));
+  if (ops & MIN)
+    result.Set("min", number_or_null(min));
+  if (ops & MAX)
+    result.Set("max", number_or_null(max));
+  if (ops & COUNT)
+    result.Set("count", Number::New(env, count));
+  if (ops & MEAN)
+    result.Set("mean", number_or_null(sum / count));
+  return result;
+}
+
+namespace {
+
+typedef map<string, uint32_t, std::less<>> Children;
+constexpr uint32_t no_child = std::numeric_limits<uint32_t>::max();
+
+uint32_t Lookup(const Children &children, std::string_view key) {
+  auto it = children.find(key);
+  return it == children.end() ? no_child : it->second;
+}
+
+// Array indices are converted to strings only when there are named children
+uint32_t Lookup(const Children &children, size_t index) {
+  if (children.empty())
+    return no_child;
+  char buffer[24];
+  auto r = std::to_chars(buffer, buffer + sizeof(buffer), index);
+  return Lookup(children, std::string_view(buffer, r.ptr - buffer));
+}
+
+} // namespace
+
+Projection::Projection(const vector<string> &_pick, const vector<string> &_omit) : pick(none), omit(none) {
+  if (!_pick.empty()) {
+    pick = NewNode();
+    for (const auto &pointer : _pick)
+      Add(pick, pointer);
+  }
+  if (!_omit.empty()) {
+    omit = NewNode();
+    for (const auto &pointer : _omit)
+      Add(omit, pointer);
+    if (nodes[omit].terminal)
+      throw std::runtime_error("omit cannot contain the root");
+  }
+}
+
+uint32_t Projection::NewNode() {
+  nodes.push_back({{}, none, false});
+  return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+// Split an RFC6901 pointer in unescaped segments, * is a wildcard
+void Projection::Add(uint32_t node, const string &pointer) {
+  if (!pointer.empty() && pointer[0] != '/') {
+    throw simdjson_error(INVALID_JSON_POINTER);
+  }
+
+  size_t pos = 0;
+  while (pos < pointer.size()) {
+    size_t next = pointer.find('/', pos + 1);
+    if (next == string::npos)
+      next = pointer.size();
+    string segment;
+    for (size_t i = pos + 1; i < next; i++) {
+      if (pointer[i] == '~' && i + 1 < next && (pointer[i + 1] == '0' || pointer[i + 1] == '1')) {
+        segment.push_back(pointer[++i] == '0' ? '~' : '/');
+      } else if (pointer[i] == '~') {
+        throw simdjson_error(INVALID_JSON_POINTER);
+      } else {
+        segment.push_back(pointer[i]);
+      }
+    }
+
+    // NewNode() can reallocate the nodes
+    uint32_t child = segment == "*" ? nodes[node].wildcard : Lookup(nodes[node].children, segment);
+    if (child == none) {
+      child = NewNode();
+      if (segment == "*")
+        nodes[node].wildcard = child;
+      else
+        nodes[node].children.emplace(segment, child);
+    }
+    node = child;
+    pos = next;
+  }
+  nodes[node].terminal = true;
+}
+
+Projection::State Projection::Root() const {
+  State state;
+  state.all = pick == none || nodes[pick].terminal;
+  if (!state.all)
+    state.pick.push_back(pick);
+  if (omit != none)
+    state.omit.push_back(omit);
+  return state;
+}
+
+template <typename K> bool Projection::Match(const State &parent, const K &key, bool container, State &child) const {
+  child.all = parent.all;
+  child.pick.clear();
+  child.omit.clear();
+
+  if (!parent.all) {
+    for (auto node : parent.pick) {
+      for (auto next : {Lookup(nodes[node].children, key), nodes[node].wildcard}) {
+        if (next == none)
+          continue;
+        if (nodes[next].terminal)
+          child.all = true;
+        else
+          child.pick.push_back(next);
+      }
+    }
+    if (child.all)
+      child.pick.clear();
+    // Only arrays and objects can contain the picked descendants
+    else if (child.pick.empty() || !container)
+      return false;
+  }
+
+  for (auto node : parent.omit) {
+    for (auto next : {Lookup(nodes[node].children, key), nodes[node].wildcard}) {
+      if (next == none)
+        continue;
+      if (nodes[next].terminal)
+        return false;
+      child.omit.push_back(next);
+    }
+  }
+  return true;
+}
+
+static inline bool IsContainer(const element &el) {
+  return el.type() == element_type::ARRAY || el.type() == element_type::OBJECT;
+}
+
+bool Projection::Enter(const State &parent, std::string_view key, const element &value, State &child) const {
+  return Match(parent, key, IsContainer(value), child);
+}
+
+bool Projection::Enter(const State &parent, size_t index, const element &value, State &child) const {
+  return Match(parent, index, IsContainer(value), child);
+}
+
+bool Projection::Enter(const State &parent, std::string_view key, bool container, State &child) const {
+  return Match(parent, key, container, child);
+}
+
+bool Projection::Enter(const State &parent, size_t index, bool container, State &child) const {
+  return Match(parent, index, container, child);
+}
+
+} // namespace Query
@@ -1,35 +1,200 @@
 #include "jsonAsync.h"
+#include <algorithm>
+
+// The run queue of toObjectAsync()
+//
+// Each conversion runs in slices of at most JSON.sliceNodes nodes
+// and at most its latency, after each slice it goes back in the line
+// behind the conversions of the same priority (round-robin)
+
+unsigned JSON::sliceNodes = 4096;
+unsigned JSON::targetLoopDelay = 0;
+
+ToObjectAsync::Statistics::Statistics()
+    : jobs(0), slices(0), nodes(0), slice_wait(0), slice_wait_max(0), job_wait(0), job_wait_max(0) {}
+
+ToObjectAsync::LoopDelay::LoopDelay() : sent(), pending(false), samples(), next(0) {}
+
+void ToObjectAsync::LoopDelay::Add(high_resolution_clock::duration delay) {
+  double ms = duration<double, std::milli>(delay).count();
+  if (samples.size() < window) {
+    samples.push_back(ms);
+  } else {
+    samples[next] = ms;
+    next = (next + 1) % window;
+  }
+}
+
+double ToObjectAsync::LoopDelay::P99() const {
+  if (samples.empty())
+    return 0;
+  vector<double> sorted(samples);
+  auto p99 = sorted.begin() + (sorted.size() * 99) / 100;
+  std::nth_element(sorted.begin(), p99, sorted.end());
+  return *p99;
+}
+
+void JSON::Enqueue(InstanceData *instance, std::shared_ptr<ToObjectAsync::Context> state) {
+  state->seq = instance->runQueueSeq++;
+  state->queued = high_resolution_clock::now();
+  instance->runQueue.push(state);
+  // Do not allow the Node.js process to exit, we are not finished
+  uv_ref(reinterpret_cast<uv_handle_t *>(&instance->runQueueJob));
+  WakeRunQueue(instance);
+}
+
+// Ask libuv to call the micro task handler after one event loop iteration
+void JSON::WakeRunQueue(InstanceData *instance) {
+  auto &delay = instance->runQueueDelay;
+  // Multiple calls before the callback are coalesced by libuv
+  if (!delay.pending) {
+    delay.pending = true;
+    delay.sent = high_resolution_clock::now();
+  }
+  uv_async_send(&instance->runQueueJob);
+}
+
+// In adaptive mode, the time slice is what remains of the target
+// loop delay after the time the event loop needs for the other tasks
+// (the p99 of the gaps between uv_async_send() and the callback)
+void JSON::AdaptLatency(InstanceData *instance, const high_resolution_clock::time_point &now) {
+  auto &delay = instance->runQueueDelay;
+  if (delay.pending) {
+    delay.Add(now - delay.sent);
+    delay.pending = false;
+  }
+  if (targetLoopDelay == 0) {
+    instance->runQueueLatency = latency;
+    return;
+  }
+  double slice = targetLoopDelay - delay.P99();
+  instance->runQueueLatency = static_cast<unsigned>(std::max(1.0, std::min<double>(slice, targetLoopDelay)));
+}
+
+// The clock is read often enough to overshoot the latency
+// by at most 1/clock_check_fraction
+static constexpr double clock_check_fraction = 16;
+static constexpr size_t clock_check_max = 4096;
+
+void JSON::AdaptClockCheck(InstanceData *instance, size_t nodes, high_resolution_clock::duration elapsed) {
+  if (nodes < instance->runQueueCheck)
+    return;
+  double cost = duration<double, std::nano>(elapsed).count() / nodes;
+  // Exponential moving average of the cost of a node
+  instance->runQueueNodeCost =
+      instance->runQueueNodeCost > 0 ? (instance->runQueueNodeCost * 7 + cost) / 8 : cost;
+
+  double budget = duration<double, std::nano>(milliseconds(instance->runQueueLatency)).count() / clock_check_fraction;
+  size_t check = 1;
+  while (check < clock_check_max && (check * 2) * instance->runQueueNodeCost <= budget)
+    check *= 2;
+  instance->runQueueCheck = check;
+}
 
 // Process the micro task queue
 // (this is a process.nextTick re-implemented in C++)
+// The clock is read once per slice, its reading is shared by the
+// end of a slice, the queue accounting and the start of the next slice
 void JSON::ProcessRunQueue(uv_async_t *handle) {
   const auto start(high_resolution_clock::now());
 
   auto instance = static_cast<InstanceData *>(handle->data);
-  while (!instance->runQueue.empty() && CanRun(start)) {
+  auto &stats = instance->runQueueStats;
+  AdaptLatency(instance, start);
+  auto now = start;
+  while (!instance->runQueue.empty() && CanRun(start, now, instance->runQueueLatency)) {
     // An operation that has finished will have its state
     // deleted by args going out of scope
-    auto args = instance->runQueue.front();
-    ToObjectAsync(args, start);
+    auto args = instance->runQueue.top();
     instance->runQueue.pop();
+
+    auto wait = now - args->queued;
+    args->waited += wait;
+    stats.slices++;
+    stats.slice_wait += wait;
+    stats.slice_wait_max = std::max(stats.slice_wait_max, wait);
+
+    uint64_t nodes = stats.nodes;
+    bool done = ToObjectAsync(args, now);
+    auto end = high_resolution_clock::now();
+    AdaptClockCheck(instance, stats.nodes - nodes, end - now);
+    now = end;
+
+    if (done) {
+      stats.jobs++;
+      stats.job_wait += args->waited;
+      stats.job_wait_max = std::max(stats.job_wait_max, args->waited);
+      continue;
+    }
+    // Put us back in the line, behind the jobs of the same priority
+    args->seq = instance->runQueueSeq++;
+    args->queued = now;
+    instance->runQueue.push(args);
   }
 
   if (!instance->runQueue.empty()) {
     // More work, ask libuv to call us back after
     // one full event loop iteration
-    uv_async_send(handle);
+    WakeRunQueue(instance);
   } else {
     // No more work, do not block the process exit
     uv_unref(reinterpret_cast<uv_handle_t *>(handle));
   }
+}
 
+Value JSON::SliceNodesGetter(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  return Number::New(env, sliceNodes);
 }
 
-void JSON::ProcessExternalMemory(Napi::Env env) {
+void JSON::SliceNodesSetter(const CallbackInfo &info, const Napi::Value &val) {
+  Napi::Env env(info.Env());
+  if (!val.IsNumber() || val.As<Number>().Int32Value() < 0)
+    throw TypeError::New(env, "Invalid value, must be a number of nodes, 0 for unlimited");
+  sliceNodes = val.As<Number>().Uint32Value();
+}
+
+Value JSON::TargetLoopDelayGetter(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  return Number::New(env, targetLoopDelay);
+}
+
+void JSON::TargetLoopDelaySetter(const CallbackInfo &info, const Napi::Value &val) {
+  Napi::Env env(info.Env());
+  if (!val.IsNumber() || val.As<Number>().Int32Value() < 0)
+    throw TypeError::New(env, "Invalid value, must be a number in milliseconds, 0 to disable");
+  targetLoopDelay = val.As<Number>().Uint32Value();
+}
+
+Value JSON::SchedulerStats(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
   auto instance = env.GetInstanceData<InstanceData>();
-  std::lock_guard guard{instance->lock};
-  if (instance->pendingExternalMemoryAdjustment != 0) {
-    Napi::MemoryManagement::AdjustExternalMemory(env, instance->pendingExternalMemoryAdjustment);
-    instance->pendingExternalMemoryAdjustment = 0;
+  auto &stats = instance->runQueueStats;
+  auto ms = [](high_resolution_clock::duration d) { return duration<double, std::milli>(d).count(); };
+
+  auto result = Object::New(env);
+  result.Set("depth", Number::New(env, instance->runQueue.size()));
+  result.Set("jobs", Number::New(env, stats.jobs));
+  result.Set("slices", Number::New(env, stats.slices));
+  result.Set("nodes", Number::New(env, stats.nodes));
+  result.Set("sliceWaitMean", Number::New(env, stats.slices ? ms(stats.slice_wait) / stats.slices : 0));
+  result.Set("sliceWaitMax", Number::New(env, ms(stats.slice_wait_max)));
+  result.Set("jobWaitMean", Number::New(env, stats.jobs ? ms(stats.job_wait) / stats.jobs : 0));
+  result.Set("jobWaitMax", Number::New(env, ms(stats.job_wait_max)));
+  result.Set("clockCheck", Number::New(env, instance->runQueueCheck));
+  result.Set("latency", Number::New(env, instance->runQueueLatency));
+  result.Set("loopDelayP99", Number::New(env, instance->runQueueDelay.P99()));
+
+  if (info.Length() > 0 && info[0].ToBoolean().Value())
+    stats = ToObjectAsync::Statistics();
+  return result;
+}
+
+void JSON::ProcessExternalMemory(Napi::Env env) {
+  auto memory = env.GetInstanceData<InstanceData>()->memory;
+  std::lock_guard guard{memory->lock};
+  if (memory->pendingAdjustment != 0) {
+    Napi::MemoryManagement::AdjustExternalMemory(env, memory->pendingAdjustment);
+    memory->pendingAdjustment = 0;
   }
 }
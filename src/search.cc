@@ -0,0 +1,168 @@
+#include "jsonAsync.h"
+#include <cstring>
+
+namespace {
+
+// memchr() is vectorized in all C libraries, it is used to
+// find the candidates for the first character of the needle
+const char *Find(const char *p, const char *end, const std::string_view &needle) {
+  if (needle.empty())
+    return p;
+  while (size_t(end - p) >= needle.size()) {
+    p = static_cast<const char *>(memchr(p, needle[0], end - p - needle.size() + 1));
+    if (p == nullptr)
+      return nullptr;
+    if (!memcmp(p + 1, needle.data() + 1, needle.size() - 1))
+      return p;
+    p++;
+  }
+  return nullptr;
+}
+
+// The strings of a subtree are contiguous in the string buffer,
+// first and last delimit the bytes from its first to its last string
+void StringsRange(const element &el, const char *&first, const char *&last) {
+  auto add = [&first, &last](const std::string_view &str) {
+    if (first == nullptr)
+      first = str.data();
+    last = str.data() + str.size();
+  };
+  switch (el.type()) {
+  case element_type::ARRAY:
+    for (element child : dom::array(el))
+      StringsRange(child, first, last);
+    break;
+  case element_type::OBJECT:
+    for (auto field : dom::object(el)) {
+      add(field.key);
+      StringsRange(field.value, first, last);
+    }
+    break;
+  case element_type::STRING:
+    add(el.get_string());
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * Scans the string buffer for the needle and maps the matches back
+ * to the strings encountered during the traversal of the tape.
+ *
+ * The strings are stored in the string buffer in the order of the tape,
+ * so there is only one pass over the string buffer, the strings that
+ * come before the next match are not examined at all.
+ */
+class StringSearch {
+  const std::string_view needle;
+  const char *end;
+  const char *next;
+  const char *searched;
+
+public:
+  bool keys, values;
+  vector<string> results;
+
+  // Only the strings of the subtree at root are scanned
+  StringSearch(const element &root, const std::string_view &_needle, bool _keys, bool _values)
+      : needle(_needle), end(nullptr), next(nullptr), searched(nullptr), keys(_keys), values(_values) {
+    const char *start = nullptr;
+    StringsRange(root, start, end);
+    if (start == nullptr)
+      return;
+    searched = start;
+    next = Find(start, end, needle);
+  }
+
+  bool Contains(const std::string_view &str) {
+    const char *p = str.data();
+    if (next != nullptr && next < p && searched < p) {
+      // The last match was in a string that was skipped
+      next = Find(p, end, needle);
+      searched = p;
+    }
+    if (next == nullptr || next < p || next + needle.size() > p + str.size())
+      return false;
+    // This string has a match, find the next one after it
+    searched = p + str.size();
+    next = Find(searched, end, needle);
+    return true;
+  }
+
+  void Walk(const element &el, string &path) {
+    switch (el.type()) {
+    case element_type::ARRAY: {
+      size_t i = 0;
+      size_t len = path.size();
+      for (element child : dom::array(el)) {
+        path += '/';
+        path += to_string(i++);
+        Walk(child, path);
+        path.resize(len);
+      }
+      break;
+    }
+    case element_type::OBJECT: {
+      size_t len = path.size();
+      for (auto field : dom::object(el)) {
+        path += '/';
+        for (char c : field.key) {
+          if (c == '~')
+            path += "~0";
+          else if (c == '/')
+            path += "~1";
+          else
+            path += c;
+        }
+        if (keys && Contains(field.key))
+          results.push_back(path);
+        Walk(field.value, path);
+        path.resize(len);
+      }
+      break;
+    }
+    case element_type::STRING:
+      if (values && Contains(el.get_string()) && (results.empty() || results.back() != path))
+        results.push_back(path);
+      break;
+    default:
+      break;
+    }
+  }
+};
+
+} // namespace
+
+Value JSON::Search(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  bool keys = true, values = true;
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    throw TypeError::New(env, "search expects a string");
+  }
+  if (info.Length() > 1) {
+    if (!info[1].IsObject()) {
+      throw TypeError::New(env, "options must be an object");
+    }
+    auto opts = info[1].As<Object>();
+    if (!opts.Get("keys").IsUndefined())
+      keys = opts.Get("keys").ToBoolean().Value();
+    if (!opts.Get("values").IsUndefined())
+      values = opts.Get("values").ToBoolean().Value();
+  }
+
+  try {
+    auto needle = info[0].As<String>().Utf8Value();
+    StringSearch search(root, needle, keys, values);
+    string path;
+    search.Walk(root, path);
+
+    auto result = Array::New(env, search.results.size());
+    for (size_t i = 0; i < search.results.size(); i++)
+      result.Set(i, String::New(env, search.results[i]));
+    return result;
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
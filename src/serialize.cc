@@ -0,0 +1,51 @@
+#include "jsonAsync.h"
+
+Value JSON::SerializeResult(Napi::Env env, std::string &&text, SerializeMode mode) {
+  if (mode == SERIALIZE_STRING) {
+    return String::New(env, text.data(), text.size());
+  }
+  // The Buffer takes ownership of the string
+  auto data = new std::string(std::move(text));
+  return Buffer<char>::NewOrCopy(
+      env, data->data(), data->size(), [](Napi::Env, char *, std::string *data) { delete data; }, data);
+}
+
+Value JSON::Serialize(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  try {
+    return SerializeResult(env, simdjson::minify(root), SERIALIZE_STRING);
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
+
+Value JSON::ToBuffer(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  try {
+    return SerializeResult(env, simdjson::minify(root), SERIALIZE_BUFFER);
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
+
+Value JSON::SerializeAsync(const CallbackInfo &info, SerializeMode mode) {
+  class SerializeAsyncWorker : public JSONAsyncWorker {
+    SerializeMode mode;
+    std::string text;
+
+  public:
+    SerializeAsyncWorker(Napi::Env env, const JSONElementContext &_context, SerializeMode _mode)
+        : JSONAsyncWorker(env, _context), mode(_mode) {}
+    virtual void Execute() override { text = simdjson::minify(context.root); }
+    virtual void OnOK() override { deferred.Resolve(SerializeResult(Env(), std::move(text), mode)); }
+  };
+
+  Napi::Env env(info.Env());
+  auto worker = new SerializeAsyncWorker(env, *this, mode);
+
+  worker->Queue();
+  return worker->GetPromise();
+}
+
+Value JSON::SerializeAsync(const CallbackInfo &info) { return SerializeAsync(info, SERIALIZE_STRING); }
+Value JSON::ToBufferAsync(const CallbackInfo &info) { return SerializeAsync(info, SERIALIZE_BUFFER); }
@@ -0,0 +1,100 @@
+#include "jsonAsync.h"
+#include <random>
+
+// Sharing of parsed documents between environments (worker_threads)
+//
+// The tape is immutable once parsed and can be read from multiple
+// threads. A shared document is registered in a process-wide
+// registry under a token that can be sent to another environment.
+// There it is opened into a new JSON with its own object stores.
+// The tokens are random so that they cannot be guessed, the entries
+// are dropped when the JSON or the environment that shared them is
+// destroyed.
+
+namespace {
+
+struct SharedDocument {
+  // The environment that shared it
+  InstanceData *instance;
+  std::shared_ptr<padded_string> input_text;
+  std::shared_ptr<parser> parser_;
+  std::shared_ptr<element> document;
+  element root;
+};
+
+const std::string token_prefix = "everything-json:";
+
+// 128 random bits in hex
+constexpr size_t token_words = 4;
+
+std::mutex registry_lock;
+std::map<std::string, SharedDocument> registry;
+
+// Must be called with the registry lock held
+std::string NewToken() {
+  static std::random_device random;
+  static const char hex[] = "0123456789abcdef";
+  std::string token;
+  do {
+    token = token_prefix;
+    for (size_t i = 0; i < token_words; i++) {
+      uint32_t word = static_cast<uint32_t>(random());
+      for (int shift = 28; shift >= 0; shift -= 4)
+        token += hex[(word >> shift) & 0xf];
+    }
+  } while (registry.count(token));
+  return token;
+}
+
+} // namespace
+
+void JSON::Unshare(const std::string &token) {
+  std::lock_guard guard{registry_lock};
+  registry.erase(token);
+}
+
+void JSON::UnshareAll(InstanceData *instance) {
+  std::lock_guard guard{registry_lock};
+  for (auto entry = registry.begin(); entry != registry.end();) {
+    if (entry->second.instance == instance)
+      entry = registry.erase(entry);
+    else
+      entry++;
+  }
+}
+
+Value JSON::Share(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+
+  if (shared_token.empty()) {
+    std::lock_guard guard{registry_lock};
+    shared_token = NewToken();
+    registry.emplace(shared_token, SharedDocument{instance, input_text, parser_, document, root});
+  }
+  return String::New(env, shared_token);
+}
+
+Value JSON::Open(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+
+  if (info.Length() != 1 || !info[0].IsString()) {
+    throw TypeError::New(env, "open expects a single token argument");
+  }
+
+  std::string token = info[0].As<String>().Utf8Value();
+  SharedDocument shared;
+  {
+    std::lock_guard guard{registry_lock};
+    auto entry = registry.find(token);
+    if (entry == registry.end()) {
+      throw Error::New(env, "Invalid token or the shared document has been released");
+    }
+    shared = entry->second;
+  }
+
+  JSONElementContext context(env, shared.input_text, shared.parser_, shared.document, shared.root);
+  napi_value ctor_args = External<JSONElementContext>::New(env, &context);
+  return New(instance, shared.root, context.store_json.get(), &ctor_args);
+}
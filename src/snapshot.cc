@@ -0,0 +1,289 @@
+#include "jsonAsync.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Binary snapshots of a parsed document
+//
+// The file contains a header padded to 64 bytes, followed
+// by the tape and the string buffer exactly as they are in memory
+// and SIMDJSON_PADDING zero bytes (simdjson can read past the end
+// of the string buffer). Loading maps the file and uses it as the
+// document without parsing it again.
+//
+// By default, loading checks only the header, the bounds and the
+// root words - it is O(1) and the pages are read only when they are
+// used. A corrupted snapshot can then make the accessors read outside
+// of the mapping. The full structural validation is O(n) and reads
+// the whole tape, it is reserved for files that are not trusted.
+
+namespace {
+
+constexpr char snapshot_magic[8] = {'E', 'J', 'S', 'O', 'N', 'T', 'A', 'P'};
+constexpr uint32_t snapshot_version = 1;
+// The tape is stored in the native byte order
+constexpr uint32_t snapshot_byte_order = 0x01020304;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t tape_length;
+  uint64_t strings_length;
+  uint8_t reserved[32];
+};
+static_assert(sizeof(Header) == 64, "The snapshot header must be 64 bytes");
+
+/**
+ * A read-only memory mapped file
+ */
+class Mapping {
+#ifdef _WIN32
+  HANDLE file, mapping;
+#endif
+
+public:
+  const uint8_t *data;
+  size_t size;
+
+  Mapping(const std::string &path);
+  ~Mapping();
+  Mapping(const Mapping &) = delete;
+  Mapping &operator=(const Mapping &) = delete;
+};
+
+#ifdef _WIN32
+Mapping::Mapping(const std::string &path) : file(INVALID_HANDLE_VALUE), mapping(NULL), data(nullptr), size(0) {
+  file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    throw std::runtime_error("Failed opening " + path);
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < static_cast<LONGLONG>(sizeof(Header))) {
+    CloseHandle(file);
+    throw std::runtime_error("Invalid snapshot " + path);
+  }
+  size = static_cast<size_t>(file_size.QuadPart);
+  mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping != NULL)
+    data = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (data == nullptr) {
+    if (mapping != NULL)
+      CloseHandle(mapping);
+    CloseHandle(file);
+    throw std::runtime_error("Failed mapping " + path);
+  }
+}
+
+Mapping::~Mapping() {
+  UnmapViewOfFile(data);
+  CloseHandle(mapping);
+  CloseHandle(file);
+}
+#else
+Mapping::Mapping(const std::string &path) : data(nullptr), size(0) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Failed opening " + path + ": " + strerror(errno));
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+    close(fd);
+    throw std::runtime_error("Invalid snapshot " + path);
+  }
+  size = static_cast<size_t>(st.st_size);
+  void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping remains valid after closing the file
+  close(fd);
+  if (p == MAP_FAILED)
+    throw std::runtime_error("Failed mapping " + path + ": " + strerror(errno));
+  data = static_cast<const uint8_t *>(p);
+}
+
+Mapping::~Mapping() { munmap(const_cast<uint8_t *>(data), size); }
+#endif
+
+[[noreturn]] void Invalid() { throw std::runtime_error("Corrupted snapshot"); }
+
+inline internal::tape_type Type(const uint64_t *tape, size_t i) {
+  return static_cast<internal::tape_type>(tape[i] >> 56);
+}
+
+// The root words at both ends of the tape
+void ValidateRoot(const uint64_t *tape, size_t len) {
+  if (len < 3 || Type(tape, 0) != internal::tape_type::ROOT || (tape[0] & internal::JSON_VALUE_MASK) != len ||
+      Type(tape, len - 1) != internal::tape_type::ROOT || (tape[len - 1] & internal::JSON_VALUE_MASK) != 0)
+    Invalid();
+}
+
+// A corrupted snapshot must not be able to make the
+// element accessors read outside of the mapping
+void Validate(const uint64_t *tape, size_t len, const uint8_t *strings, size_t strings_len) {
+  auto type = [tape](size_t i) { return Type(tape, i); };
+  auto payload = [tape](size_t i) { return tape[i] & internal::JSON_VALUE_MASK; };
+
+  // The currently open containers
+  vector<size_t> open;
+  for (size_t i = 1; i < len - 1; i++) {
+    switch (type(i)) {
+    case internal::tape_type::START_ARRAY:
+    case internal::tape_type::START_OBJECT: {
+      size_t close = static_cast<uint32_t>(payload(i));
+      if (close <= i + 1 || close > len - 1)
+        Invalid();
+      open.push_back(i);
+      break;
+    }
+    case internal::tape_type::END_ARRAY:
+    case internal::tape_type::END_OBJECT: {
+      auto start = type(i) == internal::tape_type::END_ARRAY ? internal::tape_type::START_ARRAY
+                                                             : internal::tape_type::START_OBJECT;
+      if (open.empty() || payload(i) != open.back() || type(open.back()) != start ||
+          static_cast<uint32_t>(payload(open.back())) != i + 1)
+        Invalid();
+      open.pop_back();
+      break;
+    }
+    case internal::tape_type::STRING: {
+      size_t offset = payload(i);
+      uint32_t str_len;
+      if (offset + sizeof(str_len) > strings_len)
+        Invalid();
+      memcpy(&str_len, strings + offset, sizeof(str_len));
+      if (offset + sizeof(str_len) + str_len + 1 > strings_len)
+        Invalid();
+      break;
+    }
+    case internal::tape_type::INT64:
+    case internal::tape_type::UINT64:
+    case internal::tape_type::DOUBLE:
+      // The number itself is in the next word
+      if (++i >= len - 1)
+        Invalid();
+      break;
+    case internal::tape_type::TRUE_VALUE:
+    case internal::tape_type::FALSE_VALUE:
+    case internal::tape_type::NULL_VALUE:
+      break;
+    default:
+      Invalid();
+    }
+    // There is a single root value
+    if (open.empty() && i != len - 2)
+      Invalid();
+  }
+  if (!open.empty())
+    Invalid();
+}
+
+} // namespace
+
+namespace Tape {
+
+void Save(const document &doc, const std::string &path) {
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+  header.version = snapshot_version;
+  header.byte_order = snapshot_byte_order;
+  header.tape_length = Length(doc);
+  header.strings_length = StringsLength(doc);
+
+  FILE *file = fopen(path.c_str(), "wb");
+  if (file == nullptr)
+    throw std::runtime_error("Failed opening " + path + ": " + strerror(errno));
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+            fwrite(doc.tape.get(), sizeof(uint64_t), header.tape_length, file) == header.tape_length &&
+            fwrite(doc.string_buf.get(), 1, header.strings_length, file) == header.strings_length;
+  static const uint8_t padding[SIMDJSON_PADDING] = {0};
+  ok = ok && fwrite(padding, 1, sizeof(padding), file) == sizeof(padding);
+  ok = fclose(file) == 0 && ok;
+  if (!ok)
+    throw std::runtime_error("Failed writing " + path);
+}
+
+std::shared_ptr<parser> Load(const std::string &path, bool validate) {
+  auto mapping = std::make_shared<Mapping>(path);
+
+  Header header;
+  memcpy(&header, mapping->data, sizeof(header));
+  if (memcmp(header.magic, snapshot_magic, sizeof(header.magic)))
+    throw std::runtime_error(path + " is not a snapshot");
+  if (header.version != snapshot_version || header.byte_order != snapshot_byte_order)
+    throw std::runtime_error(path + " is an incompatible snapshot");
+  size_t available = mapping->size - sizeof(header);
+  if (header.tape_length > available / sizeof(uint64_t) ||
+      header.strings_length + SIMDJSON_PADDING > available - header.tape_length * sizeof(uint64_t))
+    Invalid();
+
+  // The header size keeps the tape aligned
+  auto tape = reinterpret_cast<const uint64_t *>(mapping->data + sizeof(header));
+  auto strings = mapping->data + sizeof(header) + header.tape_length * sizeof(uint64_t);
+  ValidateRoot(tape, header.tape_length);
+  if (validate)
+    Validate(tape, header.tape_length, strings, header.strings_length);
+
+  // The document buffers belong to the mapping, they
+  // must be released before the parser is destroyed
+  auto parser_ = std::shared_ptr<parser>(new parser, [mapping](parser *p) {
+    p->doc.tape.release();
+    p->doc.string_buf.release();
+    delete p;
+  });
+  parser_->doc.tape.reset(const_cast<uint64_t *>(tape));
+  parser_->doc.string_buf.reset(const_cast<uint8_t *>(strings));
+  return parser_;
+}
+
+} // namespace Tape
+
+Value JSON::Save(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+
+  if (info.Length() != 1 || !info[0].IsString()) {
+    throw TypeError::New(env, "save expects a single path argument");
+  }
+
+  try {
+    Tape::Save(parser_->doc, info[0].As<String>().Utf8Value());
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+  return env.Undefined();
+}
+
+Value JSON::Load(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+
+  if (info.Length() < 1 || info.Length() > 2 || !info[0].IsString()) {
+    throw TypeError::New(env, "load expects a path and an optional options argument");
+  }
+  bool validate = false;
+  if (info.Length() > 1 && !info[1].IsUndefined()) {
+    if (!info[1].IsObject()) {
+      throw TypeError::New(env, "options must be an object");
+    }
+    validate = info[1].As<Object>().Get("validate").ToBoolean().Value();
+  }
+
+  try {
+    auto parser_ = Tape::Load(info[0].As<String>().Utf8Value(), validate);
+    auto document = Napi::MakeTracking<element>(env, 0, parser_->doc.root());
+
+    element root = *document.get();
+    JSONElementContext context(env, nullptr, parser_, document, root);
+    napi_value ctor_args = External<JSONElementContext>::New(env, &context);
+    return New(instance, root, context.store_json.get(), &ctor_args);
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
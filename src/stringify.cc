@@ -0,0 +1,591 @@
+#include "jsonAsync.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+// JSON.stringify() for JS values
+//
+// The main thread only captures the object graph in a compact
+// snapshot, the escaping of the strings and the formatting
+// of the numbers can happen in a background thread
+
+namespace {
+
+// Same as the default simdjson depth limit
+constexpr size_t max_depth = 1024;
+// Larger output buffers are not retained in the pool
+constexpr size_t max_pooled_capacity = 16 * 1024 * 1024;
+constexpr size_t max_pooled_buffers = 4;
+
+struct Snapshot {
+  enum Op : uint8_t {
+    OBJECT_BEGIN,
+    OBJECT_END,
+    ARRAY_BEGIN,
+    ARRAY_END,
+    KEY,
+    STRING,
+    // Strings with lone surrogates are stored already escaped
+    RAW_KEY,
+    RAW_STRING,
+    NUMBER,
+    TRUE,
+    FALSE,
+    NUL,
+    ELEMENT
+  };
+  vector<Op> ops;
+  vector<double> numbers;
+  vector<size_t> lengths;
+  std::string strings;
+  // JSON elements are serialized from their binary representation
+  vector<JSONElementContext> elements;
+};
+
+// Escapes a ", \ or a control character
+inline void EscapeChar(char c, std::string &out) {
+  static const char hex[] = "0123456789abcdef";
+  switch (c) {
+  case '"':
+    out += "\\\"";
+    break;
+  case '\\':
+    out += "\\\\";
+    break;
+  case '\b':
+    out += "\\b";
+    break;
+  case '\f':
+    out += "\\f";
+    break;
+  case '\n':
+    out += "\\n";
+    break;
+  case '\r':
+    out += "\\r";
+    break;
+  case '\t':
+    out += "\\t";
+    break;
+  default:
+    out += "\\u00";
+    out += hex[static_cast<unsigned char>(c) >> 4];
+    out += hex[static_cast<unsigned char>(c) & 0xf];
+  }
+}
+
+inline bool IsSpecial(char c) { return static_cast<unsigned char>(c) < 0x20 || c == '"' || c == '\\'; }
+
+inline bool IsHighSurrogate(char16_t c) { return c >= 0xd800 && c <= 0xdbff; }
+inline bool IsLowSurrogate(char16_t c) { return c >= 0xdc00 && c <= 0xdfff; }
+
+// JSON.stringify() escapes the lone surrogates as \udxxx,
+// everything else is converted to UTF-8
+void EscapeUTF16(const std::u16string &s, std::string &out) {
+  static const char hex[] = "0123456789abcdef";
+  out += '"';
+  for (size_t i = 0; i < s.size(); i++) {
+    uint32_t c = s[i];
+    if (c < 0x80) {
+      if (IsSpecial(static_cast<char>(c)))
+        EscapeChar(static_cast<char>(c), out);
+      else
+        out += static_cast<char>(c);
+    } else if (c < 0x800) {
+      out += static_cast<char>(0xc0 | (c >> 6));
+      out += static_cast<char>(0x80 | (c & 0x3f));
+    } else if (IsHighSurrogate(c) && i + 1 < s.size() && IsLowSurrogate(s[i + 1])) {
+      c = 0x10000 + ((c - 0xd800) << 10) + (s[++i] - 0xdc00);
+      out += static_cast<char>(0xf0 | (c >> 18));
+      out += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+      out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (c & 0x3f));
+    } else if (IsHighSurrogate(c) || IsLowSurrogate(c)) {
+      out += "\\u";
+      for (int shift = 12; shift >= 0; shift -= 4)
+        out += hex[(c >> shift) & 0xf];
+    } else {
+      out += static_cast<char>(0xe0 | (c >> 12));
+      out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+  }
+  out += '"';
+}
+
+#define CHECK(call)                                                                                                    \
+  if ((call) != napi_ok)                                                                                               \
+    throw Error::New(env);
+
+class Capture {
+  Napi::Env env;
+  InstanceData *instance;
+  Snapshot &snapshot;
+  vector<napi_value> ancestors;
+
+  void String(napi_value value, Snapshot::Op op) {
+    size_t len;
+    CHECK(napi_get_value_string_utf8(env, value, nullptr, 0, &len));
+    size_t start = snapshot.strings.size();
+    snapshot.strings.resize(start + len + 1);
+    CHECK(napi_get_value_string_utf8(env, value, &snapshot.strings[start], len + 1, nullptr));
+    snapshot.strings.resize(start + len);
+    // napi_get_value_string_utf8() replaces the lone surrogates with U+FFFD,
+    // only these strings are read again as UTF-16
+    if (std::string_view(&snapshot.strings[start], len).find("\xEF\xBF\xBD") != std::string_view::npos &&
+        EscapeLoneSurrogates(value, start)) {
+      len = snapshot.strings.size() - start;
+      op = op == Snapshot::KEY ? Snapshot::RAW_KEY : Snapshot::RAW_STRING;
+    }
+    snapshot.lengths.push_back(len);
+    snapshot.ops.push_back(op);
+  }
+
+  // Replaces the string at start with its escaped form if it has lone surrogates
+  bool EscapeLoneSurrogates(napi_value value, size_t start) {
+    size_t len;
+    CHECK(napi_get_value_string_utf16(env, value, nullptr, 0, &len));
+    std::u16string utf16(len + 1, 0);
+    CHECK(napi_get_value_string_utf16(env, value, &utf16[0], len + 1, nullptr));
+    utf16.resize(len);
+    bool lone = false;
+    for (size_t i = 0; i < len && !lone; i++) {
+      if (IsHighSurrogate(utf16[i]) && i + 1 < len && IsLowSurrogate(utf16[i + 1]))
+        i++;
+      else
+        lone = IsHighSurrogate(utf16[i]) || IsLowSurrogate(utf16[i]);
+    }
+    if (!lone)
+      return false;
+    snapshot.strings.resize(start);
+    EscapeUTF16(utf16, snapshot.strings);
+    return true;
+  }
+
+  // JSON objects and the proxify() proxies that pass InstanceOf without being wrapped,
+  // returns nullptr for any other object that inherits from JSON.prototype
+  JSON *UnwrapJSON(napi_value value) {
+    void *wrapped;
+    if (napi_unwrap(env, value, &wrapped) == napi_ok)
+      return static_cast<JSON *>(static_cast<ObjectWrap<JSON> *>(wrapped));
+    napi_value target;
+    if (napi_get_property(env, value, instance->proxy_target.Value(), &target) == napi_ok &&
+        napi_unwrap(env, target, &wrapped) == napi_ok)
+      return static_cast<JSON *>(static_cast<ObjectWrap<JSON> *>(wrapped));
+    // The accessor throws when it cannot unwrap its receiver
+    bool pending;
+    CHECK(napi_is_exception_pending(env, &pending));
+    if (pending) {
+      napi_value error;
+      CHECK(napi_get_and_clear_last_exception(env, &error));
+    }
+    return nullptr;
+  }
+
+  // new Number(), new String() and new Boolean() are serialized as primitives
+  void Unbox(napi_value &value, napi_valuetype &type) {
+    bool is;
+    CHECK(napi_instanceof(env, value, instance->Number_ctor.Value(), &is));
+    if (is) {
+      CHECK(napi_coerce_to_number(env, value, &value));
+      type = napi_number;
+      return;
+    }
+    CHECK(napi_instanceof(env, value, instance->String_ctor.Value(), &is));
+    if (is) {
+      CHECK(napi_coerce_to_string(env, value, &value));
+      type = napi_string;
+      return;
+    }
+    CHECK(napi_instanceof(env, value, instance->Boolean_ctor.Value(), &is));
+    if (is) {
+      auto valueOf = instance->Boolean_ctor.Value().Get("prototype").As<Object>().Get("valueOf").As<Function>();
+      value = valueOf.Call(value, {});
+      type = napi_boolean;
+    }
+  }
+
+  void Enter(napi_value value) {
+    if (ancestors.size() >= max_depth)
+      throw RangeError::New(env, "Maximum nesting depth exceeded");
+    for (auto ancestor : ancestors) {
+      bool same;
+      CHECK(napi_strict_equals(env, ancestor, value, &same));
+      if (same)
+        throw TypeError::New(env, "Converting circular structure to JSON");
+    }
+    ancestors.push_back(value);
+  }
+
+public:
+  Capture(Napi::Env _env, Snapshot &_snapshot)
+      : env(_env), instance(_env.GetInstanceData<InstanceData>()), snapshot(_snapshot) {}
+
+  // Returns false if the value is not serializable and must be
+  // skipped in objects / replaced by null in arrays,
+  // a null key is the array index, created only for toJSON
+  bool Value(napi_value value, napi_value key, uint32_t index = 0) {
+    HandleScope scope(env);
+
+    napi_valuetype type;
+    CHECK(napi_typeof(env, value, &type));
+    if (type == napi_object) {
+      // Date and all other objects with toJSON
+      napi_value toJSON;
+      napi_valuetype toJSON_type;
+      CHECK(napi_get_named_property(env, value, "toJSON", &toJSON));
+      CHECK(napi_typeof(env, toJSON, &toJSON_type));
+      if (toJSON_type == napi_function) {
+        if (key == nullptr)
+          CHECK(napi_create_string_utf8(env, to_string(index).c_str(), NAPI_AUTO_LENGTH, &key));
+        CHECK(napi_call_function(env, value, toJSON, 1, &key, &value));
+        CHECK(napi_typeof(env, value, &type));
+      }
+      if (type == napi_object)
+        Unbox(value, type);
+    }
+
+    switch (type) {
+    case napi_null:
+      snapshot.ops.push_back(Snapshot::NUL);
+      return true;
+    case napi_boolean: {
+      bool b;
+      CHECK(napi_get_value_bool(env, value, &b));
+      snapshot.ops.push_back(b ? Snapshot::TRUE : Snapshot::FALSE);
+      return true;
+    }
+    case napi_number: {
+      double number;
+      CHECK(napi_get_value_double(env, value, &number));
+      snapshot.numbers.push_back(number);
+      snapshot.ops.push_back(Snapshot::NUMBER);
+      return true;
+    }
+    case napi_string:
+      String(value, Snapshot::STRING);
+      return true;
+    case napi_bigint:
+      throw TypeError::New(env, "Do not know how to serialize a BigInt");
+    case napi_object:
+      break;
+    case napi_external:
+      snapshot.ops.push_back(Snapshot::OBJECT_BEGIN);
+      snapshot.ops.push_back(Snapshot::OBJECT_END);
+      return true;
+    default:
+      // undefined, functions and symbols
+      return false;
+    }
+
+    auto object = Napi::Value(env, value).As<Object>();
+    if (object.InstanceOf(instance->JSON_ctor.Value())) {
+      JSON *json = UnwrapJSON(value);
+      if (json != nullptr) {
+        const JSONElementContext &context = json->GetContext();
+        snapshot.elements.emplace_back(context, context.root);
+        snapshot.ops.push_back(Snapshot::ELEMENT);
+        return true;
+      }
+    }
+
+    Enter(value);
+    bool is_array;
+    CHECK(napi_is_array(env, value, &is_array));
+    if (is_array) {
+      uint32_t len;
+      CHECK(napi_get_array_length(env, value, &len));
+      snapshot.ops.push_back(Snapshot::ARRAY_BEGIN);
+      for (uint32_t i = 0; i < len; i++) {
+        HandleScope scope(env);
+        napi_value element;
+        CHECK(napi_get_element(env, value, i, &element));
+        if (!Value(element, nullptr, i))
+          snapshot.ops.push_back(Snapshot::NUL);
+      }
+      snapshot.ops.push_back(Snapshot::ARRAY_END);
+    } else {
+      napi_value keys;
+      uint32_t len;
+      CHECK(napi_get_all_property_names(env, value, napi_key_own_only,
+                                        static_cast<napi_key_filter>(napi_key_enumerable | napi_key_skip_symbols),
+                                        napi_key_numbers_to_strings, &keys));
+      CHECK(napi_get_array_length(env, keys, &len));
+      snapshot.ops.push_back(Snapshot::OBJECT_BEGIN);
+      for (uint32_t i = 0; i < len; i++) {
+        HandleScope scope(env);
+        napi_value key, property;
+        CHECK(napi_get_element(env, keys, i, &key));
+        CHECK(napi_get_property(env, value, key, &property));
+        size_t ops = snapshot.ops.size(), lengths = snapshot.lengths.size(), strings = snapshot.strings.size();
+        String(key, Snapshot::KEY);
+        if (!Value(property, key)) {
+          // Roll back the key
+          snapshot.ops.resize(ops);
+          snapshot.lengths.resize(lengths);
+          snapshot.strings.resize(strings);
+        }
+      }
+      snapshot.ops.push_back(Snapshot::OBJECT_END);
+    }
+    ancestors.pop_back();
+    return true;
+  }
+};
+
+#undef CHECK
+
+class Writer {
+  std::string &out;
+
+  // Escaping is needed only for ", \ and the control characters,
+  // check 8 bytes at a time for any of these (SWAR)
+  static inline bool HasSpecial(const char *p) {
+    constexpr uint64_t ones = 0x0101010101010101ULL;
+    constexpr uint64_t highs = 0x8080808080808080ULL;
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    uint64_t control = (w - ones * 0x20) & ~w & highs;
+    uint64_t quote = w ^ (ones * '"');
+    quote = (quote - ones) & ~quote & highs;
+    uint64_t backslash = w ^ (ones * '\\');
+    backslash = (backslash - ones) & ~backslash & highs;
+    return (control | quote | backslash) != 0;
+  }
+
+  void Escaped(const char *s, size_t len) {
+    out += '"';
+    size_t start = 0, i = 0;
+    while (i < len) {
+      while (i + 8 <= len && !HasSpecial(s + i))
+        i += 8;
+      while (i < len && !IsSpecial(s[i]))
+        i++;
+      if (i == len)
+        break;
+      out.append(s + start, i - start);
+      EscapeChar(s[i], out);
+      start = ++i;
+    }
+    out.append(s + start, len - start);
+    out += '"';
+  }
+
+  // ECMAScript Number::toString
+  void Number(double number) {
+    if (!std::isfinite(number)) {
+      out += "null";
+      return;
+    }
+    if (number == 0) {
+      out += '0';
+      return;
+    }
+    if (std::trunc(number) == number && std::fabs(number) < 1e15) {
+      out += to_string(static_cast<int64_t>(number));
+      return;
+    }
+
+    // std::to_chars() guarantees the shortest digits that
+    // round-trip, as ECMAScript requires, as [-]d.ddde[+-]xx
+    char buffer[64];
+    char *end = std::to_chars(buffer, buffer + sizeof(buffer) - 1, number, std::chars_format::scientific).ptr;
+    *end = '\0';
+    const char *p = buffer;
+    if (*p == '-') {
+      out += '-';
+      p++;
+    }
+    std::string digits;
+    int point = -1, exponent = 0;
+    for (; p < end && *p != 'e' && *p != 'E'; p++) {
+      if (*p == '.')
+        point = static_cast<int>(digits.size());
+      else
+        digits += *p;
+    }
+    if (p < end)
+      exponent = atoi(p + 1);
+    if (point < 0)
+      point = static_cast<int>(digits.size());
+    // Normalize to 0.ddd x 10^n
+    int n = point + exponent;
+    size_t first = digits.find_first_not_of('0');
+    n -= static_cast<int>(first);
+    digits.erase(0, first);
+    digits.erase(digits.find_last_not_of('0') + 1);
+    int k = static_cast<int>(digits.size());
+
+    if (k <= n && n <= 21) {
+      out += digits;
+      out.append(n - k, '0');
+    } else if (0 < n && n <= 21) {
+      out.append(digits, 0, n);
+      out += '.';
+      out.append(digits, n, string::npos);
+    } else if (-6 < n && n <= 0) {
+      out += "0.";
+      out.append(-n, '0');
+      out += digits;
+    } else {
+      out += digits[0];
+      if (k > 1) {
+        out += '.';
+        out.append(digits, 1, string::npos);
+      }
+      out += 'e';
+      out += n - 1 >= 0 ? '+' : '-';
+      out += to_string(std::abs(n - 1));
+    }
+  }
+
+public:
+  Writer(std::string &_out) : out(_out) {}
+
+  void Write(const Snapshot &snapshot) {
+    const char *strings = snapshot.strings.data();
+    auto number = snapshot.numbers.begin();
+    auto length = snapshot.lengths.begin();
+    auto element = snapshot.elements.begin();
+    // Whether a comma is needed before the next value
+    bool comma = false;
+
+    for (auto op : snapshot.ops) {
+      if (comma && op != Snapshot::OBJECT_END && op != Snapshot::ARRAY_END)
+        out += ',';
+      comma = true;
+      switch (op) {
+      case Snapshot::OBJECT_BEGIN:
+        out += '{';
+        comma = false;
+        break;
+      case Snapshot::OBJECT_END:
+        out += '}';
+        break;
+      case Snapshot::ARRAY_BEGIN:
+        out += '[';
+        comma = false;
+        break;
+      case Snapshot::ARRAY_END:
+        out += ']';
+        break;
+      case Snapshot::KEY:
+        Escaped(strings, *length);
+        out += ':';
+        strings += *length++;
+        comma = false;
+        break;
+      case Snapshot::STRING:
+        Escaped(strings, *length);
+        strings += *length++;
+        break;
+      case Snapshot::RAW_KEY:
+        out.append(strings, *length);
+        out += ':';
+        strings += *length++;
+        comma = false;
+        break;
+      case Snapshot::RAW_STRING:
+        out.append(strings, *length);
+        strings += *length++;
+        break;
+      case Snapshot::NUMBER:
+        Number(*number++);
+        break;
+      case Snapshot::TRUE:
+        out += "true";
+        break;
+      case Snapshot::FALSE:
+        out += "false";
+        break;
+      case Snapshot::NUL:
+        out += "null";
+        break;
+      case Snapshot::ELEMENT:
+        out += simdjson::minify((element++)->root);
+        break;
+      }
+    }
+  }
+};
+
+std::string AcquireBuffer(InstanceData *instance) {
+  if (instance->stringifyPool.empty())
+    return std::string();
+  std::string buffer = std::move(instance->stringifyPool.back());
+  instance->stringifyPool.pop_back();
+  return buffer;
+}
+
+void ReleaseBuffer(InstanceData *instance, std::string &&buffer) {
+  if (buffer.capacity() > max_pooled_capacity || instance->stringifyPool.size() >= max_pooled_buffers)
+    return;
+  buffer.clear();
+  instance->stringifyPool.push_back(std::move(buffer));
+}
+
+void CheckArguments(const CallbackInfo &info) {
+  if (info.Length() != 1) {
+    throw TypeError::New(info.Env(),
+                         "JSON.stringify{Async} expects a single argument, replacer and space are not supported");
+  }
+}
+
+} // namespace
+
+Value JSON::Stringify(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  auto instance = env.GetInstanceData<InstanceData>();
+  CheckArguments(info);
+
+  Snapshot snapshot;
+  Capture capture(env, snapshot);
+  if (!capture.Value(info[0], String::New(env, "")))
+    return env.Undefined();
+
+  std::string out = AcquireBuffer(instance);
+  try {
+    Writer(out).Write(snapshot);
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+  auto result = String::New(env, out.data(), out.size());
+  ReleaseBuffer(instance, std::move(out));
+  return result;
+}
+
+Value JSON::StringifyAsync(const CallbackInfo &info) {
+  class StringifyAsyncWorker : public AsyncWorker {
+    Promise::Deferred deferred;
+    Snapshot snapshot;
+    std::string out;
+
+  public:
+    StringifyAsyncWorker(Napi::Env env, Snapshot &&_snapshot)
+        : AsyncWorker(env, "JSONAsyncWorker"), deferred(env), snapshot(std::move(_snapshot)),
+          out(AcquireBuffer(env.GetInstanceData<InstanceData>())) {}
+    virtual void Execute() override { Writer(out).Write(snapshot); }
+    virtual void OnOK() override {
+      Napi::Env env = Env();
+      deferred.Resolve(String::New(env, out.data(), out.size()));
+      ReleaseBuffer(env.GetInstanceData<InstanceData>(), std::move(out));
+    }
+    virtual void OnError(const Napi::Error &e) override { deferred.Reject(e.Value()); }
+    Promise GetPromise() { return deferred.Promise(); }
+  };
+
+  Napi::Env env(info.Env());
+  CheckArguments(info);
+
+  Snapshot snapshot;
+  Capture capture(env, snapshot);
+  if (!capture.Value(info[0], String::New(env, ""))) {
+    auto deferred = Promise::Deferred::New(env);
+    deferred.Resolve(env.Undefined());
+    return deferred.Promise();
+  }
+
+  auto worker = new StringifyAsyncWorker(env, std::move(snapshot));
+  worker->Queue();
+  return worker->GetPromise();
+}
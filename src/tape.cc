@@ -0,0 +1,72 @@
+#include "jsonAsync.h"
+
+// Direct access to the simdjson tape, see
+// https://github.com/simdjson/simdjson/blob/master/doc/tape.md
+namespace Tape {
+
+size_t Length(const document &doc) {
+  if (!doc.tape)
+    return 0;
+  // The first root word points right after the last one
+  return size_t(doc.tape[0] & internal::JSON_VALUE_MASK);
+}
+
+size_t StringsLength(const document &doc) {
+  size_t len = Length(doc);
+  size_t strings = 0;
+  // Strings are appended to the string buffer in the order
+  // of the tape, the last string marks its end
+  for (size_t i = 0; i < len; i++) {
+    auto type = static_cast<internal::tape_type>(doc.tape[i] >> 56);
+    switch (type) {
+    case internal::tape_type::STRING: {
+      size_t offset = size_t(doc.tape[i] & internal::JSON_VALUE_MASK);
+      uint32_t str_len;
+      memcpy(&str_len, &doc.string_buf[offset], sizeof(str_len));
+      strings = offset + sizeof(str_len) + str_len + 1;
+      break;
+    }
+    case internal::tape_type::INT64:
+    case internal::tape_type::UINT64:
+    case internal::tape_type::DOUBLE:
+      // The number itself is in the next word
+      i++;
+      break;
+    default:
+      break;
+    }
+  }
+  return strings;
+}
+
+void Relocate(uint64_t *dst, size_t index, const uint64_t *src, size_t from, size_t to, uint64_t strings_offset) {
+  uint64_t delta = index - from;
+  for (size_t i = from; i < to; i++, index++) {
+    uint64_t word = src[i];
+    switch (static_cast<internal::tape_type>(word >> 56)) {
+    case internal::tape_type::START_ARRAY:
+    case internal::tape_type::START_OBJECT:
+      // The count is in the upper bits of the payload
+      dst[index] = (word & ~uint64_t(0xFFFFFFFF)) | uint32_t(uint32_t(word) + delta);
+      break;
+    case internal::tape_type::END_ARRAY:
+    case internal::tape_type::END_OBJECT:
+      dst[index] = word + delta;
+      break;
+    case internal::tape_type::STRING:
+      dst[index] = word + strings_offset;
+      break;
+    case internal::tape_type::INT64:
+    case internal::tape_type::UINT64:
+    case internal::tape_type::DOUBLE:
+      dst[index] = word;
+      dst[++index] = src[++i];
+      break;
+    default:
+      dst[index] = word;
+      break;
+    }
+  }
+}
+
+} // namespace Tape
@@ -2,21 +2,151 @@
 
 namespace ToObjectAsync {
 
-Element::Element(const element &_item) : item(_item), iterator({{}}) {}
+Element::Element(const element &_item) : item(_item), iterator({{}}), idx(0), pos(0) {}
 Context::Context(Napi::Env _env, Napi::Value _self)
-    : env(_env), self(Persistent(_self)), top(), stack(), deferred(env) {}
+    : env(_env), self(Persistent(_self)), top(), stack(), deferred(env), pc(0), latency(0), priority(0), seq(0),
+      queued(), waited(0) {}
 
 } // namespace ToObjectAsync
 
+// The options shared by toObjectAsync() and toObjectChunkAsync(),
+// returns false if the signal is already aborted
+static bool GetOptions(Napi::Env env, ToObjectAsync::Context &state, const Napi::Value &options) {
+  if (options.IsUndefined())
+    return true;
+  if (!options.IsObject()) {
+    throw TypeError::New(env, "options must be an object");
+  }
+  Napi::Value opt = options.As<Object>().Get("latency");
+  if (!opt.IsUndefined()) {
+    if (!opt.IsNumber() || opt.As<Number>().Int32Value() <= 0) {
+      throw TypeError::New(env, "latency must be a positive number in milliseconds");
+    }
+    state.latency = opt.As<Number>().Uint32Value();
+  }
+  opt = options.As<Object>().Get("priority");
+  if (!opt.IsUndefined()) {
+    if (!opt.IsNumber()) {
+      throw TypeError::New(env, "priority must be a number");
+    }
+    state.priority = opt.As<Number>().Int32Value();
+  }
+  state.cancel.Listen(env, options, state.deferred);
+  return !state.cancel.Aborted();
+}
+
+// Advance the iterator of an array or an object to its next member
+// that is in the projection, returns false at the end
+static bool Project(const Query::Projection &projection, ToObjectAsync::Element &parent,
+                    Query::Projection::State &child) {
+  if (Query::Projection::All(parent.projection)) {
+    child = parent.projection;
+    return parent.item.type() == element_type::ARRAY ? parent.iterator.array.idx != parent.iterator.array.end
+                                                      : parent.iterator.object.idx != parent.iterator.object.end;
+  }
+  if (parent.item.type() == element_type::ARRAY) {
+    auto &it = parent.iterator.array;
+    for (; it.idx != it.end; ++it.idx, ++parent.pos)
+      if (projection.Enter(parent.projection, parent.pos, *it.idx, child))
+        return true;
+    return false;
+  }
+  auto &it = parent.iterator.object;
+  for (; it.idx != it.end; ++it.idx) {
+    auto field = *it.idx;
+    if (projection.Enter(parent.projection, field.key, field.value, child))
+      return true;
+  }
+  return false;
+}
+
 // Main JS entry point
 Value JSON::ToObjectAsync(const CallbackInfo &info) {
   Napi::Env env(info.Env());
 
   // The ToObjectAsync state is created here and it exists
   // as long as it sits on the queue
+  // A latency of 0 follows the default of the run queue
+  auto state = Napi::MakeTracking<ToObjectAsync::Context>(env, 0, env, info.This());
+  if (info.Length() > 0 && !GetOptions(env, *state, info[0]))
+    return state->deferred.Promise();
+  try {
+    state->projection = GetProjection(env, info.Length() > 0 ? info[0] : env.Undefined());
+  } catch (const Napi::Error &) {
+    state->cancel.Release();
+    throw;
+  }
+  if (info.Length() > 0 && info[0].IsObject() && info[0].As<Object>().Get("offload").ToBoolean().Value()) {
+    ToObjectPlan(state, root);
+    return state->deferred.Promise();
+  }
+  state->stack.emplace_back(root);
+  if (state->projection)
+    state->stack.back().projection = state->projection->Root();
+  // Even the first slice runs from the run queue, after the promise has been returned
+  Enqueue(env.GetInstanceData<InstanceData>(), state);
+
+  return state->deferred.Promise();
+}
+
+// The position of toObjectStream() in an array
+Value JSON::ToObjectCursor(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+
+  if (root.type() != element_type::ARRAY) {
+    throw TypeError::New(env, "toObjectStream expects an array");
+  }
+  auto cursor = new ToObjectAsync::Cursor{parser_, dom::array(root).begin(), dom::array(root).end()};
+  return External<ToObjectAsync::Cursor>::New(env, cursor,
+                                              [](Napi::Env, ToObjectAsync::Cursor *cursor) { delete cursor; });
+}
+
+// Converts the next chunkSize elements of the array at the cursor,
+// resolves with an empty array at the end
+Value JSON::ToObjectChunkAsync(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+
+  if (info.Length() < 2 || !info[0].IsExternal() || !info[1].IsNumber()) {
+    throw TypeError::New(env, "toObjectChunkAsync expects a cursor and a chunk size");
+  }
+  auto cursor = info[0].As<External<ToObjectAsync::Cursor>>().Data();
+  if (cursor->parser_ != parser_) {
+    throw TypeError::New(env, "The cursor belongs to another document");
+  }
+  if (info[1].As<Number>().Int32Value() <= 0) {
+    throw TypeError::New(env, "chunkSize must be a positive number");
+  }
+  size_t chunkSize = info[1].As<Number>().Uint32Value();
+
   auto state = Napi::MakeTracking<ToObjectAsync::Context>(env, 0, env, info.This());
+  if (info.Length() > 2 && !GetOptions(env, *state, info[2]))
+    return state->deferred.Promise();
+
+  // Advancing an array iterator skips over the whole element on the tape
+  auto first = cursor->pos;
+  size_t len = 0;
+  while (cursor->pos != cursor->end && len < chunkSize) {
+    ++cursor->pos;
+    len++;
+  }
+  auto chunk = Array::New(env, len);
+  state->top = Persistent<Napi::Value>(chunk);
+  if (len == 0) {
+    state->cancel.Release();
+    state->deferred.Resolve(chunk);
+    return state->deferred.Promise();
+  }
+
+  // The traversal starts inside the array, at the first element of the chunk,
+  // it ends when it backtracks to the array
   state->stack.emplace_back(root);
-  ToObjectAsync(state, high_resolution_clock::now());
+  auto &array = state->stack.back();
+  array.ref = Persistent<Napi::Value>(chunk);
+  array.iterator.array.idx = first;
+  array.iterator.array.end = cursor->pos;
+  array.idx = 0;
+  state->stack.emplace_back(*first);
+  Enqueue(env.GetInstanceData<InstanceData>(), state);
 
   return state->deferred.Promise();
 }
@@ -24,16 +154,34 @@ Value JSON::ToObjectAsync(const CallbackInfo &info) {
 #define LAST(v) (&(v).end()[-1])
 #define PENULT(v) (((v).size() > 1) ? (&(v).end()[-2]) : nullptr)
 
-// The actual implementation, called from the JS entry point
-// and the task queue loop, runs until it is allowed, keeps its
-// context in std::shared_ptr<ToObjectAsync::Context> state
+// The actual implementation, called from the task queue loop,
+// runs one slice - until it is allowed or until it has converted
+// sliceNodes nodes, keeps its context in
+// std::shared_ptr<ToObjectAsync::Context> state
 // (this is an iterative heterogenous tree traversal)
-void JSON::ToObjectAsync(std::shared_ptr<ToObjectAsync::Context> state, high_resolution_clock::time_point start) {
+// Returns true when the conversion has been settled
+bool JSON::ToObjectAsync(std::shared_ptr<ToObjectAsync::Context> state, high_resolution_clock::time_point start) {
   Napi::Env env = state->env;
   auto &stack = state->stack;
 
+  // An aborted conversion has already been rejected, it is simply
+  // not put back in the line
+  if (state->cancel.Aborted())
+    return true;
+  if (state->program)
+    return ToObjectRun(state, start);
+
+  auto instance = env.GetInstanceData<InstanceData>();
+  size_t nodes = 0;
+  const size_t limit = sliceNodes > 0 ? sliceNodes : std::numeric_limits<size_t>::max();
+  // The clock is read only every clock_mask + 1 nodes
+  const size_t clock_mask = instance->runQueueCheck - 1;
+  const unsigned budget = state->latency > 0 ? state->latency : instance->runQueueLatency;
+
   HandleScope scope(env);
   Napi::Value result;
+  const Query::Projection *projection = state->projection.get();
+  Query::Projection::State child;
 
   ToObjectAsync::Element *current, *previous;
   try {
@@ -45,9 +193,11 @@ void JSON::ToObjectAsync(std::shared_ptr<ToObjectAsync::Context> state, high_res
 
     // Evaluate the item and create a JS representation
     do {
+      nodes++;
       switch (current->item.type()) {
       case element_type::ARRAY: {
-        size_t len = dom::array(current->item).size();
+        // The projected arrays are compacted
+        size_t len = projection ? 0 : dom::array(current->item).size();
         auto array = Array::New(env, len);
         current->ref = Persistent<Napi::Value>(array);
         result = array;
@@ -115,22 +265,30 @@ void JSON::ToObjectAsync(std::shared_ptr<ToObjectAsync::Context> state, high_res
         current->iterator.array.idx = dom::array(current->item).begin();
         current->iterator.array.end = dom::array(current->item).end();
         current->idx = 0;
-        if (current->iterator.array.idx == current->iterator.array.end) {
+        current->pos = 0;
+        if (projection ? !Project(*projection, *current, child)
+                       : current->iterator.array.idx == current->iterator.array.end) {
           goto empty;
         }
+        // This invalidates current and previous
         stack.emplace_back(*current->iterator.array.idx);
         current = LAST(stack);
         previous = PENULT(stack);
+        if (projection)
+          current->projection = std::move(child);
         break;
       case element_type::OBJECT:
         current->iterator.object.idx = dom::object(current->item).begin();
         current->iterator.object.end = dom::object(current->item).end();
-        if (current->iterator.object.idx == current->iterator.object.end) {
+        if (projection ? !Project(*projection, *current, child)
+                       : current->iterator.object.idx == current->iterator.object.end) {
           goto empty;
         }
         stack.emplace_back((*current->iterator.object.idx).value);
         current = LAST(stack);
         previous = PENULT(stack);
+        if (projection)
+          current->projection = std::move(child);
         break;
 
       default:
@@ -143,26 +301,33 @@ void JSON::ToObjectAsync(std::shared_ptr<ToObjectAsync::Context> state, high_res
           switch (previous->item.type()) {
           case element_type::ARRAY: {
             previous->idx++;
+            previous->pos++;
             previous->iterator.array.idx++;
-            if (previous->iterator.array.idx == previous->iterator.array.end) {
+            if (projection ? !Project(*projection, *previous, child)
+                           : previous->iterator.array.idx == previous->iterator.array.end) {
               backtracked = true;
               stack.pop_back();
               current = LAST(stack);
               previous = PENULT(stack);
             } else {
               current->item = *previous->iterator.array.idx;
+              if (projection)
+                current->projection = std::move(child);
             }
             break;
           }
           case element_type::OBJECT: {
             previous->iterator.object.idx++;
-            if (previous->iterator.object.idx == previous->iterator.object.end) {
+            if (projection ? !Project(*projection, *previous, child)
+                           : previous->iterator.object.idx == previous->iterator.object.end) {
               backtracked = true;
               stack.pop_back();
               current = LAST(stack);
               previous = PENULT(stack);
             } else {
               current->item = (*previous->iterator.object.idx).value;
+              if (projection)
+                current->projection = std::move(child);
             }
             break;
           }
@@ -174,22 +339,19 @@ void JSON::ToObjectAsync(std::shared_ptr<ToObjectAsync::Context> state, high_res
 
       // if previous == nullptr here, we have successfully
       // recursed our way back to the top
-    } while (previous && CanRun(start));
+    } while (previous && nodes < limit && ((nodes & clock_mask) || CanRun(start, budget)));
   } catch (const exception &err) {
+    state->cancel.Release();
     state->deferred.Reject(Error::New(env, err.what()).Value());
-    return;
+    return true;
   }
+  instance->runQueueStats.nodes += nodes;
 
   if (!previous) {
     assert(!state->top.IsEmpty());
+    state->cancel.Release();
     state->deferred.Resolve(state->top.Value());
-  } else {
-    // Put us back in the line
-    auto instance = env.GetInstanceData<InstanceData>();
-    instance->runQueue.push(state);
-    // Do not allow the Node.js process to exit, we are not finished
-    uv_ref(reinterpret_cast<uv_handle_t *>(&instance->runQueueJob));
-    // Ask libuv to call the micro task handler after one event loop iteration
-    uv_async_send(&instance->runQueueJob);
+    return true;
   }
+  return false;
 }
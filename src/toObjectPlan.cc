@@ -0,0 +1,227 @@
+#include "jsonAsync.h"
+
+// toObjectAsync({ offload: true })
+//
+// The tape traversal, the type dispatch and the number conversions
+// are done in a background thread which produces a Program,
+// the run queue slices only execute it on the main thread
+
+namespace {
+
+using ToObjectAsync::Program;
+
+class Planner {
+  Program &program;
+  std::unordered_map<std::string_view, uint32_t> keys;
+  const Query::Projection *projection;
+
+  void Emit(Program::Op op) { program.code.push_back(op); }
+  void Emit(Program::Op op, size_t operand) {
+    if (operand > std::numeric_limits<uint32_t>::max())
+      throw simdjson_error(CAPACITY);
+    program.code.push_back(op);
+    program.code.push_back(static_cast<uint32_t>(operand));
+  }
+
+public:
+  Planner(Program &_program, const Query::Projection *_projection) : program(_program), projection(_projection) {}
+
+  void Plan(const element &el) {
+    if (projection)
+      Plan(el, projection->Root());
+    else
+      Plan(el, Query::Projection::State{true, {}, {}});
+  }
+
+  // The nesting is limited by the maximum depth of the parser
+  void Plan(const element &el, const Query::Projection::State &state) {
+    bool all = Query::Projection::All(state);
+    Query::Projection::State child{true, {}, {}};
+    switch (el.type()) {
+    case element_type::ARRAY: {
+      dom::array array(el);
+      size_t at = program.code.size();
+      Emit(Program::ARRAY, array.size());
+      size_t i = 0, len = 0;
+      for (element value : array) {
+        if (all || projection->Enter(state, i++, value, child)) {
+          Plan(value, child);
+          len++;
+        }
+      }
+      // The projected arrays are compacted
+      program.code[at + 1] = static_cast<uint32_t>(len);
+      Emit(Program::END);
+      break;
+    }
+    case element_type::OBJECT:
+      Emit(Program::OBJECT);
+      for (auto field : dom::object(el)) {
+        if (!all && !projection->Enter(state, field.key, field.value, child))
+          continue;
+        auto key = keys.emplace(field.key, program.keys.size());
+        if (key.second)
+          program.keys.push_back(field.key);
+        Emit(Program::KEY, key.first->second);
+        Plan(field.value, child);
+      }
+      Emit(Program::END);
+      break;
+    case element_type::STRING:
+      Emit(Program::STRING, program.strings.size());
+      program.strings.push_back(el.get_string().value_unsafe());
+      break;
+    case element_type::DOUBLE:
+    case element_type::INT64:
+    case element_type::UINT64:
+      Emit(Program::NUMBER, program.numbers.size());
+      program.numbers.push_back((double)el);
+      break;
+    case element_type::BOOL:
+      Emit((bool)el ? Program::TRUE_VALUE : Program::FALSE_VALUE);
+      break;
+    case element_type::NULL_VALUE:
+      Emit(Program::NULL_VALUE);
+      break;
+    default:
+      throw std::runtime_error("Invalid JSON element");
+    }
+  }
+};
+
+} // namespace
+
+// Build the program in a background thread, then put
+// the conversion in the run queue
+void JSON::ToObjectPlan(std::shared_ptr<ToObjectAsync::Context> state, const element &root) {
+  class PlanAsyncWorker : public AsyncJob {
+    std::shared_ptr<ToObjectAsync::Context> state;
+    element root;
+    std::shared_ptr<Program> program;
+
+  public:
+    PlanAsyncWorker(Napi::Env env, std::shared_ptr<ToObjectAsync::Context> _state, const element &_root)
+        : AsyncJob(env, _state->priority), state(_state), root(_root), program(std::make_shared<Program>()) {}
+    virtual void Execute() override {
+      if (state->cancel.Aborted())
+        return;
+      Planner(*program, state->projection.get()).Plan(root);
+    }
+    virtual void OnOK() override {
+      if (state->cancel.Aborted())
+        return;
+      Napi::Env env = Env();
+      state->keys = Persistent(Array::New(env, program->keys.size()));
+      state->program = program;
+      Enqueue(env.GetInstanceData<InstanceData>(), state);
+    }
+    virtual void OnError(const Napi::Error &e) override {
+      if (state->cancel.Aborted())
+        return;
+      state->cancel.Release();
+      state->deferred.Reject(e.Value());
+    }
+  };
+
+  // The JSON object referenced by the state keeps the document alive
+  auto worker = new PlanAsyncWorker(state->env, state, root);
+  worker->Queue();
+}
+
+// Execute one slice of the program, the same limits
+// as the tape traversal apply
+bool JSON::ToObjectRun(std::shared_ptr<ToObjectAsync::Context> state, high_resolution_clock::time_point start) {
+  Napi::Env env = state->env;
+  auto instance = env.GetInstanceData<InstanceData>();
+  const Program &program = *state->program;
+  auto &frames = state->frames;
+
+  HandleScope scope(env);
+  size_t nodes = 0;
+  const size_t limit = sliceNodes > 0 ? sliceNodes : std::numeric_limits<size_t>::max();
+  const size_t clock_mask = instance->runQueueCheck - 1;
+  const unsigned budget = state->latency > 0 ? state->latency : instance->runQueueLatency;
+
+  try {
+    Array keys = state->keys.Value();
+    while (state->pc < program.code.size()) {
+      uint32_t op = program.code[state->pc++];
+      Napi::Value result;
+      switch (op) {
+      case Program::KEY:
+        frames.back().key = program.code[state->pc++];
+        continue;
+      case Program::END:
+        frames.pop_back();
+        continue;
+      case Program::ARRAY:
+        result = Array::New(env, program.code[state->pc++]);
+        break;
+      case Program::OBJECT:
+        result = Object::New(env);
+        break;
+      case Program::STRING: {
+        const auto &str = program.strings[program.code[state->pc++]];
+        result = String::New(env, str.data(), str.size());
+        break;
+      }
+      case Program::NUMBER:
+        result = Number::New(env, program.numbers[program.code[state->pc++]]);
+        break;
+      case Program::TRUE_VALUE:
+        result = Boolean::New(env, true);
+        break;
+      case Program::FALSE_VALUE:
+        result = Boolean::New(env, false);
+        break;
+      case Program::NULL_VALUE:
+        result = env.Null();
+        break;
+      default:
+        throw Error::New(env, "Internal error");
+      }
+
+      // Set the value in its parent slot: object, array or the top
+      if (frames.empty()) {
+        state->top = Persistent(result);
+      } else {
+        auto &parent = frames.back();
+        if (parent.object) {
+          Napi::Value key = keys.Get(parent.key);
+          if (key.IsUndefined()) {
+            const auto &name = program.keys[parent.key];
+            key = String::New(env, name.data(), name.size());
+            keys.Set(parent.key, key);
+          }
+          parent.ref.Value().As<Object>().Set(key, result);
+        } else {
+          parent.ref.Value().As<Object>().Set(parent.idx++, result);
+        }
+      }
+      if (op == Program::ARRAY || op == Program::OBJECT)
+        frames.push_back({Persistent(result), op == Program::OBJECT, 0, 0});
+
+      nodes++;
+      if (nodes >= limit || (!(nodes & clock_mask) && !CanRun(start, budget)))
+        break;
+    }
+  } catch (const exception &err) {
+    state->cancel.Release();
+    state->deferred.Reject(Error::New(env, err.what()).Value());
+    return true;
+  }
+  instance->runQueueStats.nodes += nodes;
+
+  // The trailing END instructions do not need another slice
+  while (state->pc < program.code.size() && program.code[state->pc] == Program::END) {
+    frames.pop_back();
+    state->pc++;
+  }
+  if (state->pc < program.code.size())
+    return false;
+
+  assert(!state->top.IsEmpty());
+  state->cancel.Release();
+  state->deferred.Resolve(state->top.Value());
+  return true;
+}
@@ -0,0 +1,309 @@
+#include "jsonAsync.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Serialization to the V8 ValueSerializer wire format
+//
+// The output is read by v8.deserialize() which creates the whole
+// object graph in a single call, the tape traversal and the string
+// transcoding happen in a background thread
+
+namespace {
+
+// The oldest format version that has all the tags used here,
+// newer versions of V8 read all older versions
+constexpr uint8_t v8_format_version = 13;
+
+enum V8Tag : uint8_t {
+  V8_VERSION = 0xFF,
+  V8_PADDING = 0x00,
+  V8_TRUE = 'T',
+  V8_FALSE = 'F',
+  V8_NULL = '0',
+  V8_INT32 = 'I',
+  V8_DOUBLE = 'N',
+  V8_ONE_BYTE_STRING = '"',
+  V8_TWO_BYTE_STRING = 'c',
+  V8_BEGIN_OBJECT = 'o',
+  V8_END_OBJECT = '{',
+  V8_BEGIN_DENSE_ARRAY = 'A',
+  V8_END_DENSE_ARRAY = '$'
+};
+
+class V8Writer {
+  std::string &out;
+  // Scratch buffer for the strings that are not ASCII
+  vector<uint16_t> utf16;
+  // Scratch buffer for the keys of an object
+  vector<std::string_view> keys;
+
+  void Tag(V8Tag tag) { out.push_back(static_cast<char>(tag)); }
+
+  void Varint(uint64_t value) {
+    while (value >= 0x80) {
+      out.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+  }
+
+  static size_t VarintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+      value >>= 7;
+      size++;
+    }
+    return size;
+  }
+
+  void Int32(int32_t value) {
+    Tag(V8_INT32);
+    // ZigZag encoding
+    Varint((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+  }
+
+  // V8 uses the host byte order
+  void Double(double value) {
+    Tag(V8_DOUBLE);
+    char bytes[sizeof(value)];
+    memcpy(bytes, &value, sizeof(value));
+    out.append(bytes, sizeof(value));
+  }
+
+  void Number(double value) {
+    // Small integers become Smis just like with JSON.parse()
+    if (value >= std::numeric_limits<int32_t>::min() && value <= std::numeric_limits<int32_t>::max() &&
+        value == std::trunc(value) && !(value == 0 && std::signbit(value)))
+      Int32(static_cast<int32_t>(value));
+    else
+      Double(value);
+  }
+
+  // V8 strings are either Latin-1 or UTF-16
+  void String(std::string_view str) {
+    size_t i = 0;
+    while (i < str.size() && static_cast<uint8_t>(str[i]) < 0x80)
+      i++;
+    if (i == str.size()) {
+      Tag(V8_ONE_BYTE_STRING);
+      Varint(str.size());
+      out.append(str.data(), str.size());
+      return;
+    }
+
+    // The input has already been validated by simdjson
+    utf16.clear();
+    uint16_t max = 0;
+    for (i = 0; i < str.size();) {
+      uint8_t c = static_cast<uint8_t>(str[i]);
+      uint32_t cp;
+      if (c < 0x80) {
+        cp = c;
+        i += 1;
+      } else if (c < 0xE0) {
+        cp = ((c & 0x1F) << 6) | (str[i + 1] & 0x3F);
+        i += 2;
+      } else if (c < 0xF0) {
+        cp = ((c & 0x0F) << 12) | ((str[i + 1] & 0x3F) << 6) | (str[i + 2] & 0x3F);
+        i += 3;
+      } else {
+        cp = ((c & 0x07) << 18) | ((str[i + 1] & 0x3F) << 12) | ((str[i + 2] & 0x3F) << 6) | (str[i + 3] & 0x3F);
+        i += 4;
+      }
+      if (cp >= 0x10000) {
+        cp -= 0x10000;
+        utf16.push_back(static_cast<uint16_t>(0xD800 + (cp >> 10)));
+        utf16.push_back(static_cast<uint16_t>(0xDC00 + (cp & 0x3FF)));
+        max = 0xFFFF;
+      } else {
+        utf16.push_back(static_cast<uint16_t>(cp));
+        max = std::max(max, static_cast<uint16_t>(cp));
+      }
+    }
+
+    if (max <= 0xFF) {
+      Tag(V8_ONE_BYTE_STRING);
+      Varint(utf16.size());
+      for (auto ch : utf16)
+        out.push_back(static_cast<char>(ch));
+      return;
+    }
+
+    size_t byte_length = utf16.size() * sizeof(uint16_t);
+    // V8 aligns the UTF-16 data on 2 bytes
+    if ((out.size() + 1 + VarintSize(byte_length)) & 1)
+      Tag(V8_PADDING);
+    Tag(V8_TWO_BYTE_STRING);
+    Varint(byte_length);
+    for (auto ch : utf16) {
+      out.push_back(static_cast<char>(ch & 0xFF));
+      out.push_back(static_cast<char>(ch >> 8));
+    }
+  }
+
+  // v8.deserialize() rejects duplicate keys
+  bool HasDuplicateKeys(const dom::object &object) {
+    keys.clear();
+    for (auto field : object)
+      keys.push_back(field.key);
+    if (keys.size() <= 16) {
+      for (size_t i = 1; i < keys.size(); i++)
+        for (size_t j = 0; j < i; j++)
+          if (keys[i] == keys[j])
+            return true;
+      return false;
+    }
+    std::sort(keys.begin(), keys.end());
+    return std::adjacent_find(keys.begin(), keys.end()) != keys.end();
+  }
+
+  // JSON.parse() keeps the position of the first occurrence
+  // of a duplicate key with the value of the last one
+  void WriteDeduplicated(const dom::object &object) {
+    vector<std::pair<std::string_view, element>> fields;
+    std::unordered_map<std::string_view, size_t> index;
+    for (auto field : object) {
+      auto it = index.emplace(field.key, fields.size());
+      if (it.second)
+        fields.emplace_back(field.key, field.value);
+      else
+        fields[it.first->second].second = field.value;
+    }
+    Tag(V8_BEGIN_OBJECT);
+    for (auto &field : fields) {
+      String(field.first);
+      Write(field.second);
+    }
+    Tag(V8_END_OBJECT);
+    Varint(fields.size());
+  }
+
+public:
+  V8Writer(std::string &_out) : out(_out) {
+    Tag(V8_VERSION);
+    Varint(v8_format_version);
+  }
+
+  // The nesting is limited by the maximum depth of the parser
+  void Write(const element &el) {
+    switch (el.type()) {
+    case element_type::ARRAY: {
+      dom::array array(el);
+      size_t len = array.size();
+      Tag(V8_BEGIN_DENSE_ARRAY);
+      Varint(len);
+      for (element child : array)
+        Write(child);
+      Tag(V8_END_DENSE_ARRAY);
+      // No extra properties
+      Varint(0);
+      Varint(len);
+      break;
+    }
+    case element_type::OBJECT: {
+      dom::object object(el);
+      if (HasDuplicateKeys(object)) {
+        WriteDeduplicated(object);
+        break;
+      }
+      size_t count = 0;
+      Tag(V8_BEGIN_OBJECT);
+      for (auto field : object) {
+        String(field.key);
+        Write(field.value);
+        count++;
+      }
+      Tag(V8_END_OBJECT);
+      Varint(count);
+      break;
+    }
+    case element_type::STRING:
+      String(el.get_string().value_unsafe());
+      break;
+    case element_type::INT64: {
+      int64_t value = el.get_int64().value_unsafe();
+      if (value >= std::numeric_limits<int32_t>::min() && value <= std::numeric_limits<int32_t>::max())
+        Int32(static_cast<int32_t>(value));
+      else
+        Double(static_cast<double>(value));
+      break;
+    }
+    case element_type::UINT64:
+    case element_type::DOUBLE:
+      Number((double)el);
+      break;
+    case element_type::BOOL:
+      Tag((bool)el ? V8_TRUE : V8_FALSE);
+      break;
+    case element_type::NULL_VALUE:
+      Tag(V8_NULL);
+      break;
+    default:
+      throw std::runtime_error("Invalid JSON element");
+    }
+  }
+};
+
+std::string V8Serialize(const element &el) {
+  std::string out;
+  V8Writer(out).Write(el);
+  return out;
+}
+
+} // namespace
+
+Value JSON::ToV8Buffer(const CallbackInfo &info) {
+  Napi::Env env(info.Env());
+  try {
+    return SerializeResult(env, V8Serialize(root), SERIALIZE_BUFFER);
+  } catch (const exception &err) {
+    throw Error::New(env, err.what());
+  }
+}
+
+Value JSON::ToV8BufferAsync(const CallbackInfo &info) {
+  class V8SerializeAsyncWorker : public JSONAsyncWorker {
+    std::string bytes;
+    Cancellation cancel;
+
+  public:
+    V8SerializeAsyncWorker(Napi::Env env, const JSONElementContext &_context) : JSONAsyncWorker(env, _context) {}
+    virtual void Execute() override {
+      // An aborted serialization is skipped
+      if (cancel.Aborted())
+        return;
+      bytes = V8Serialize(context.root);
+    }
+    virtual void OnOK() override {
+      if (cancel.Aborted())
+        return;
+      cancel.Release();
+      deferred.Resolve(SerializeResult(Env(), std::move(bytes), SERIALIZE_BUFFER));
+    }
+    virtual void OnError(const Napi::Error &e) override {
+      if (cancel.Aborted())
+        return;
+      cancel.Release();
+      deferred.Reject(e.Value());
+    }
+    // Returns false if the signal is already aborted
+    bool Listen(const Napi::Value &options) {
+      cancel.Listen(Env(), options, deferred);
+      return !cancel.Aborted();
+    }
+  };
+
+  Napi::Env env(info.Env());
+  if (info.Length() > 1 || (info.Length() == 1 && !info[0].IsUndefined() && !info[0].IsObject())) {
+    throw TypeError::New(env, "toV8BufferAsync expects an optional options object");
+  }
+  std::unique_ptr<V8SerializeAsyncWorker> worker(new V8SerializeAsyncWorker(env, *this));
+  auto promise = worker->GetPromise();
+  if (info.Length() > 0 && !worker->Listen(info[0]))
+    return promise;
+
+  // The worker deletes itself once completed
+  worker.release()->Queue();
+  return promise;
+}
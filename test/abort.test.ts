@@ -0,0 +1,99 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import * as zlib from 'zlib';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+const jsonText = zlib.unzipSync(fs.readFileSync(path.resolve(__dirname, 'data', 'sf_citylots.json.gz')));
+
+describe('AbortSignal', function () {
+  this.timeout(20000);
+
+  it('parseAsync() with an already aborted signal', (done) => {
+    const controller = new AbortController();
+    controller.abort();
+    JSONAsync.parseAsync(jsonText, { signal: controller.signal })
+      .then(() => done(new Error('did not reject')))
+      .catch((e) => {
+        assert.strictEqual(e.name, 'AbortError');
+        done();
+      })
+      .catch(done);
+  });
+
+  it('parseAsync() rejects with the reason', (done) => {
+    const controller = new AbortController();
+    const q = JSONAsync.parseAsync(jsonText, { signal: controller.signal });
+    controller.abort(new Error('client disconnected'));
+    q.then(() => done(new Error('did not reject')))
+      .catch((e) => {
+        assert.strictEqual(e.message, 'client disconnected');
+        done();
+      })
+      .catch(done);
+  });
+
+  it('parseAsync() without aborting', (done) => {
+    const controller = new AbortController();
+    JSONAsync.parseAsync('{"a":1}', { signal: controller.signal })
+      .then((document) => {
+        assert.deepEqual(document.toObject(), { a: 1 });
+        // Aborting after the end has no effect
+        controller.abort();
+        done();
+      })
+      .catch(done);
+  });
+
+  it('parseAsync() skips queued jobs', (done) => {
+    JSONAsync.threads = 1;
+    const controller = new AbortController();
+    const first = JSONAsync.parseAsync(jsonText);
+    const second = JSONAsync.parseAsync(jsonText, { signal: controller.signal });
+    controller.abort();
+    Promise.all([first.then(() => 'fulfilled'), second.then(() => 'fulfilled', () => 'rejected')])
+      .then((status) => {
+        assert.deepEqual(status, ['fulfilled', 'rejected']);
+        done();
+      })
+      .catch(done)
+      .then(() => {
+        JSONAsync.threads = 0;
+      });
+  });
+
+  it('toObjectAsync() stops the conversion', (done) => {
+    JSONAsync.parseAsync(jsonText)
+      .then((document) => {
+        const controller = new AbortController();
+        const q = document.toObjectAsync({ signal: controller.signal });
+        setTimeout(() => controller.abort(), 5);
+        return q;
+      })
+      .then(() => done(new Error('did not reject')))
+      .catch((e) => {
+        assert.strictEqual(e.name, 'AbortError');
+        done();
+      })
+      .catch(done);
+  });
+
+  it('toObjectAsync() without aborting', (done) => {
+    const document = JSONAsync.parse('{"a":[1,2,3]}');
+    const controller = new AbortController();
+    document
+      .toObjectAsync({ signal: controller.signal })
+      .then((r) => {
+        assert.deepEqual(r, { a: [1, 2, 3] });
+        done();
+      })
+      .catch(done);
+  });
+
+  it('rejects invalid signals', () => {
+    const document = JSONAsync.parse('{"a":[1,2,3]}');
+    // @ts-expect-error
+    assert.throws(() => document.toObjectAsync({ signal: 'signal' }), /AbortSignal/);
+  });
+});
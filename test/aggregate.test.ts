@@ -0,0 +1,72 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('aggregate()', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8');
+  const expected = JSON.parse(text);
+  const followers: number[] = expected.statuses.map((s: any) => s.user.followers_count);
+  const stats = {
+    sum: followers.reduce((a, x) => a + x, 0),
+    min: Math.min(...followers),
+    max: Math.max(...followers),
+    count: followers.length,
+    mean: followers.reduce((a, x) => a + x, 0) / followers.length
+  };
+
+  it('all aggregations', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.aggregate('/statuses/*/user/followers_count');
+    assert.deepEqual(result, stats);
+  });
+
+  it('selected aggregations', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.aggregate('/statuses/*/user/followers_count', ['min', 'count']);
+    assert.deepEqual(result, { min: stats.min, count: stats.count });
+  });
+
+  it('wildcards on arrays and objects', () => {
+    const document = JSONAsync.parse(JSON.stringify({
+      a: { x: [1, 2], y: [3, 'string'] },
+      b: [{ n: 4 }, { m: 5 }, { n: null }]
+    }));
+    assert.deepEqual(document.aggregate('/a/*/*', ['sum', 'count']), { sum: 6, count: 3 });
+    assert.deepEqual(document.aggregate('/b/*/n', ['sum', 'count']), { sum: 4, count: 1 });
+    assert.deepEqual(document.path('/a').aggregate('/x/*'), { sum: 3, min: 1, max: 2, count: 2, mean: 1.5 });
+    assert.deepEqual(document.aggregate('/b/*/invalid'), { sum: 0, min: null, max: null, count: 0, mean: null });
+  });
+
+  it('throws on invalid arguments', () => {
+    const document = JSONAsync.parse(text);
+    assert.throws(() => {
+      document.aggregate('/invalid/*/value');
+    }, /NO_SUCH_FIELD/);
+    assert.throws(() => {
+      // @ts-expect-error
+      document.aggregate('/statuses/*/id', ['median']);
+    }, /Invalid operation/);
+  });
+
+  it('aggregateAsync()', (done) => {
+    JSONAsync.parseAsync(text)
+      .then((document) => document.aggregateAsync('/statuses/*/user/followers_count'))
+      .then((result) => {
+        assert.deepEqual(result, stats);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('aggregateAsync() rejects on invalid pointer', (done) => {
+    JSONAsync.parseAsync(text)
+      .then((document) => document.aggregateAsync('/invalid/*/value'))
+      .then(() => done(new Error('did not throw')))
+      .catch((e) => {
+        assert.match(e.message, /NO_SUCH_FIELD/);
+        done();
+      });
+  });
+});
@@ -0,0 +1,56 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('toObject({ depth })', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8');
+  const expected = JSON.parse(text);
+
+  it('depth 0', () => {
+    const document = JSONAsync.parse(text);
+    assert.strictEqual(document.toObject({ depth: 0 }), document);
+    assert.strictEqual(JSONAsync.parse('42').toObject({ depth: 0 }), 42);
+  });
+
+  it('depth 1 is expand()', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.toObject({ depth: 1 });
+    assert.sameMembers(Object.keys(result), Object.keys(expected));
+    assert.instanceOf(result.statuses, JSONAsync);
+    assert.strictEqual(result.statuses, document.expand().statuses);
+    assert.deepEqual(result.statuses.toObject(), expected.statuses);
+  });
+
+  it('depth 3', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.toObject({ depth: 3 });
+    const status = result.statuses[0];
+    assert.strictEqual(status.id, expected.statuses[0].id);
+    assert.strictEqual(status.text, expected.statuses[0].text);
+    assert.instanceOf(status.user, JSONAsync);
+    assert.deepEqual(status.user.toObject(), expected.statuses[0].user);
+    assert.strictEqual(status.user, document.path('/statuses/0/user'));
+  });
+
+  it('Infinity', () => {
+    const document = JSONAsync.parse(text);
+    assert.deepEqual(document.toObject({ depth: Infinity }), expected);
+  });
+
+  it('proxies', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.toObject({ depth: 2, proxy: true });
+    assert.strictEqual(result.statuses[0].user.screen_name, expected.statuses[0].user.screen_name);
+    assert.strictEqual(result.statuses[0][JSONAsync.symbolType], 'object');
+    assert.strictEqual(result.statuses[0], document.get().statuses.proxify()[0]);
+  });
+
+  it('invalid options', () => {
+    const document = JSONAsync.parse(text);
+    assert.throws(() => document.toObject({ depth: -1 }), /depth/);
+    assert.throws(() => document.toObject({ depth: 'a' as any }), /depth/);
+    assert.throws(() => document.toObject({ depth: 1, pick: ['/statuses'] } as any), /depth/);
+  });
+});
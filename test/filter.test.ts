@@ -0,0 +1,80 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('filter()', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8');
+  const expected = JSON.parse(text);
+  const statuses: any[] = expected.statuses;
+
+  it('eq', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.filter('/statuses', { field: '/user/lang', eq: 'ja' });
+    assert.isArray(result);
+    assert.instanceOf(result[0], JSONAsync);
+    assert.deepEqual(result.map((r) => r.toObject()), statuses.filter((s) => s.user.lang === 'ja'));
+    assert.strictEqual(result[0], document.path(`/statuses/${statuses.findIndex((s) => s.user.lang === 'ja')}`));
+  });
+
+  it('in, lt, gt, prefix', () => {
+    const document = JSONAsync.parse(text);
+    assert.deepEqual(
+      document.filter('/statuses', { field: '/user/lang', in: ['en', 'es'] }, { toObject: true }),
+      statuses.filter((s) => ['en', 'es'].includes(s.user.lang)));
+    assert.deepEqual(
+      document.filter('/statuses', { field: '/retweet_count', lt: 10 }, { toObject: true }),
+      statuses.filter((s) => s.retweet_count < 10));
+    assert.deepEqual(
+      document.filter('/statuses', { field: '/retweet_count', gt: 10 }, { toObject: true }),
+      statuses.filter((s) => s.retweet_count > 10));
+    assert.deepEqual(
+      document.filter('/statuses', { field: '/text', prefix: 'RT @' }, { toObject: true }),
+      statuses.filter((s) => s.text.startsWith('RT @')));
+    assert.deepEqual(
+      document.filter('/statuses', { field: '/in_reply_to_user_id', eq: null }, { toObject: true }),
+      statuses.filter((s) => s.in_reply_to_user_id === null));
+  });
+
+  it('combined predicates', () => {
+    const document = JSONAsync.parse(text);
+    assert.deepEqual(
+      document.filter('/statuses', [
+        { field: '/retweet_count', gt: 0, lt: 100 },
+        { field: '/user/lang', eq: 'ja' }
+      ], { toObject: true }),
+      statuses.filter((s) => s.retweet_count > 0 && s.retweet_count < 100 && s.user.lang === 'ja'));
+  });
+
+  it('primitive arrays', () => {
+    const document = JSONAsync.parse(JSON.stringify({ a: [1, 'a', 5, 'b', 10, true] }));
+    assert.deepEqual(document.filter('/a', { gt: 2 }, { toObject: true }), [5, 10]);
+    assert.deepEqual(document.filter('/a', { gt: 'a' }, { toObject: true }), ['b']);
+    assert.deepEqual(document.filter('/a', { eq: true }, { toObject: true }), [true]);
+  });
+
+  it('find() / findIndex()', () => {
+    const document = JSONAsync.parse(text);
+    const idx = statuses.findIndex((s) => s.retweet_count > 10);
+    assert.strictEqual(document.findIndex('/statuses', { field: '/retweet_count', gt: 10 }), idx);
+    assert.strictEqual(document.find('/statuses', { field: '/retweet_count', gt: 10 }), document.path(`/statuses/${idx}`));
+    assert.deepEqual(document.find('/statuses', { field: '/retweet_count', gt: 10 }, { toObject: true }), statuses[idx]);
+    assert.strictEqual(document.findIndex('/statuses', { field: '/user/lang', eq: 'invalid' }), -1);
+    assert.isUndefined(document.find('/statuses', { field: '/user/lang', eq: 'invalid' }));
+  });
+
+  it('throws on invalid arguments', () => {
+    const document = JSONAsync.parse(text);
+    assert.throws(() => {
+      document.filter('/search_metadata', { eq: 1 });
+    }, /INCORRECT_TYPE/);
+    assert.throws(() => {
+      document.filter('/statuses', { field: '/id' });
+    }, /at least one of/);
+    assert.throws(() => {
+      // @ts-expect-error
+      document.filter('/statuses', { field: '/id', eq: {} });
+    }, /primitive values/);
+  });
+});
@@ -51,3 +51,130 @@ it('toObjectAsync() yields the CPU', function (done) {
       clearInterval(timer);
     });
 });
+
+describe('toObjectAsync() scheduling', function () {
+  this.timeout(100000);
+
+  it('latency option', (done) => {
+    const document = JSONAsync.parse('{"a":[1,2,3]}');
+    document.toObjectAsync({ latency: 20 })
+      .then((r) => {
+        assert.deepEqual(r, { a: [1, 2, 3] });
+        // @ts-expect-error
+        assert.throws(() => document.toObjectAsync({ latency: 0 }), /positive number/);
+        // @ts-expect-error
+        assert.throws(() => document.toObjectAsync({ priority: 'high' }), /priority/);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('higher priority conversions run first', (done) => {
+    // Each event loop iteration has time for a single slice
+    JSONAsync.latency = 1;
+    JSONAsync.parseAsync<FeatureCollection>(jsonText)
+      .then((document) => {
+        const order: string[] = [];
+        const q = [
+          document.toObjectAsync({ latency: 1, priority: -1 }).then(() => order.push('background')),
+          document.toObjectAsync({ latency: 1 }).then(() => order.push('normal')),
+          document.toObjectAsync({ latency: 1, priority: 10 }).then(() => order.push('interactive'))
+        ];
+        return Promise.all(q).then(() => order);
+      })
+      .then((order) => {
+        assert.deepEqual(order, ['interactive', 'normal', 'background']);
+        done();
+      })
+      .catch(done)
+      .then(() => {
+        JSONAsync.latency = 5;
+      });
+  });
+  it('conversions take turns', (done) => {
+    JSONAsync.schedulerStats(true);
+    JSONAsync.parseAsync<FeatureCollection>(jsonText)
+      .then((document) => {
+        const order: string[] = [];
+        const q = [
+          document.toObjectAsync().then(() => order.push('large')),
+          document.get().features.get()[0].toObjectAsync().then(() => order.push('small'))
+        ];
+        assert.strictEqual(JSONAsync.schedulerStats().depth, 2);
+        return Promise.all(q).then(() => order);
+      })
+      .then((order) => {
+        assert.deepEqual(order, ['small', 'large']);
+        const stats = JSONAsync.schedulerStats();
+        assert.strictEqual(stats.depth, 0);
+        assert.strictEqual(stats.jobs, 2);
+        assert.isAbove(stats.slices, 2);
+        assert.isAbove(stats.nodes, 0);
+        assert.isAtMost(stats.sliceWaitMean, stats.sliceWaitMax);
+        assert.isAtMost(stats.jobWaitMean, stats.jobWaitMax);
+        // A power of 2
+        assert.isAbove(stats.clockCheck, 0);
+        assert.strictEqual(stats.clockCheck & (stats.clockCheck - 1), 0);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('JSON.sliceNodes', () => {
+    assert.strictEqual(JSONAsync.sliceNodes, 4096);
+    JSONAsync.sliceNodes = 0;
+    assert.strictEqual(JSONAsync.sliceNodes, 0);
+    assert.throws(() => {
+      JSONAsync.sliceNodes = -1;
+    }, /Invalid value/);
+    JSONAsync.sliceNodes = 4096;
+  });
+  it('adaptive time slicing', (done) => {
+    JSONAsync.targetLoopDelay = 20;
+    // Keep the event loop busy with other tasks
+    const timer = setInterval(() => {
+      const start = Date.now();
+      while (Date.now() - start < 5);
+    }, 1);
+    JSONAsync.parseAsync<FeatureCollection>(jsonText)
+      .then((document) => document.toObjectAsync())
+      .then((geojson) => {
+        assert.strictEqual(geojson.type, 'FeatureCollection');
+        const stats = JSONAsync.schedulerStats();
+        assert.isAbove(stats.loopDelayP99, 0);
+        assert.isAtLeast(stats.latency, 1);
+        assert.isAtMost(stats.latency, 20);
+        done();
+      })
+      .catch(done)
+      .then(() => {
+        clearInterval(timer);
+        JSONAsync.targetLoopDelay = 0;
+      });
+  });
+
+  it('JSON.targetLoopDelay', () => {
+    assert.strictEqual(JSONAsync.targetLoopDelay, 0);
+    assert.throws(() => {
+      JSONAsync.targetLoopDelay = -1;
+    }, /Invalid value/);
+  });
+  it('offloaded conversions', (done) => {
+    JSONAsync.parseAsync<FeatureCollection>(jsonText)
+      .then((document) => Promise.all([
+        document.toObjectAsync({ offload: true }),
+        document.get().features.get()[1].toObjectAsync({ offload: true }),
+        JSONAsync.parse('[1, "a", true, false, null, {"a": [{}], "b": {"a": []}}, 1.5]').toObjectAsync({ offload: true }),
+        JSONAsync.parse('"text"').toObjectAsync({ offload: true })
+      ]))
+      .then(([geojson, feature, misc, text]) => {
+        const expected = JSON.parse(jsonText.toString());
+        assert.deepEqual(geojson, expected);
+        assert.deepEqual(feature, expected.features[1]);
+        assert.deepEqual(misc, [1, 'a', true, false, null, { a: [{}], b: { a: [] } }, 1.5]);
+        assert.strictEqual(text, 'text');
+        done();
+      })
+      .catch(done);
+  });
+});
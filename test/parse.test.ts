@@ -50,6 +50,17 @@ describe('from string', () => {
       .get().coordinates.get()[10].get()[2].get()[0].type, 'number');
   });
 
+  it('typeId', () => {
+    const document = JSONAsync.parse<FeatureCollection>(text);
+
+    assert.deepEqual(JSONAsync.types, ['array', 'object', 'string', 'number', 'boolean', 'null']);
+    assert.isFrozen(JSONAsync.types);
+    assert.strictEqual(JSONAsync.types[document.typeId], 'object');
+    assert.strictEqual(JSONAsync.types[document.get().features.typeId], 'array');
+    assert.strictEqual(JSONAsync.types[document.path('/type').typeId], 'string');
+    assert.strictEqual(JSONAsync.types[document.path('/features/0/geometry/coordinates/10/2/0').typeId], 'number');
+  });
+
   it('toObject()', () => {
     const document = JSONAsync.parse<FeatureCollection>(text);
     const geometry = document.get().features.get()[0].get().geometry.toObject();
@@ -139,6 +150,66 @@ describe('from Buffer', () => {
   });
 });
 
+describe('parallel parsing', () => {
+  const statuses = JSON.parse(fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8')).statuses;
+  // About 2MB, large enough to be split
+  const expected: any[] = [];
+  for (let i = 0; i < 6; i++) expected.push(...statuses);
+  expected.push(1, 'string', null, [true, false], {});
+  const text = JSON.stringify(expected);
+
+  it('parseAsync() w/ threads', (done) => {
+    JSONAsync.parseAsync(text, { threads: 3 })
+      .then((document) => {
+        assert.strictEqual(document.type, 'array');
+        assert.strictEqual(document.get().length, expected.length);
+        assert.deepEqual(document.path('/123/user').toObject(), expected[123].user);
+        assert.deepEqual(document.toObject(), expected);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('parseAsync() w/ threads on the dedicated pool', (done) => {
+    JSONAsync.threads = 2;
+    // More threads than cores are clamped
+    JSONAsync.parseAsync(text, { threads: 1024 })
+      .then((document) => {
+        assert.deepEqual(document.toObject(), expected);
+        JSONAsync.threads = 0;
+        done();
+      })
+      .catch((e) => {
+        JSONAsync.threads = 0;
+        done(e);
+      });
+  });
+
+  it('parseAsync() w/ invalid threads', () => {
+    assert.throws(() => JSONAsync.parseAsync(text, { threads: 0 }), /positive/);
+    assert.throws(() => JSONAsync.parseAsync(text, { threads: 2 ** 32 }), /positive/);
+  });
+
+  it('parseAsync() w/ threads falls back on objects', (done) => {
+    JSONAsync.parseAsync(JSON.stringify({ expected }), { threads: 3 })
+      .then((document) => {
+        assert.deepEqual(document.toObject(), { expected });
+        done();
+      })
+      .catch(done);
+  });
+
+  it('parseAsync() w/ threads throws on invalid JSON', (done) => {
+    JSONAsync.parseAsync(text.slice(0, -100) + ',}]', { threads: 3 })
+      .then(() => done(new Error('did not throw')))
+      .catch((e) => {
+        assert.instanceOf(e, Error);
+        done();
+      })
+      .catch(done);
+  });
+});
+
 describe('latency', () => {
   it('must have a configurable latency', () => {
     assert.isNumber(JSONAsync.latency);
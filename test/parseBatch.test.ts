@@ -0,0 +1,63 @@
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('JSON.parseAsyncBatch()', () => {
+  const messages = Array.from({ length: 1000 }, (_, i) => ({ id: i, text: `message ${i}`, tags: ['a', i % 7] }));
+  const texts = messages.map((m) => JSON.stringify(m));
+
+  it('parses all documents', (done) => {
+    JSONAsync.parseAsyncBatch(texts)
+      .then((result) => {
+        assert.lengthOf(result, messages.length);
+        assert.deepEqual(result.map((r) => (r as JSONAsync).toObject()), messages);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('mixed strings and Buffers in multiple jobs', (done) => {
+    const input = texts.map((t, i) => (i % 2 ? Buffer.from(t) : t));
+    JSONAsync.parseAsyncBatch(input, { threads: 3 })
+      .then((result) => {
+        assert.deepEqual(result.map((r) => (r as JSONAsync).toObject()), messages);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('more threads than CPU cores', (done) => {
+    JSONAsync.parseAsyncBatch(texts, { threads: 2 ** 31 - 1 })
+      .then((result) => {
+        assert.deepEqual(result.map((r) => (r as JSONAsync).toObject()), messages);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('per-document errors', (done) => {
+    JSONAsync.parseAsyncBatch(['{"a":1}', '{"a":', '[]'])
+      .then((result) => {
+        assert.lengthOf(result, 3);
+        assert.deepEqual((result[0] as JSONAsync).toObject(), { a: 1 });
+        assert.instanceOf(result[1], Error);
+        assert.deepEqual((result[2] as JSONAsync).toObject(), []);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('empty batch', (done) => {
+    JSONAsync.parseAsyncBatch([])
+      .then((result) => {
+        assert.deepEqual(result, []);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('Buffer slices', () => {
+    const buffer = Buffer.from('xx{"a":1}xx');
+    assert.deepEqual(JSONAsync.parse(buffer.subarray(2, 9)).toObject(), { a: 1 });
+  });
+});
@@ -0,0 +1,67 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('newline-delimited JSON', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8');
+  const statuses: any[] = JSON.parse(text).statuses;
+  // About 2.5MB split in several chunks
+  const expected: any[] = [];
+  for (let i = 0; i < 8; i++) expected.push(...statuses);
+  const lines = expected.map((s) => JSON.stringify(s)).join('\n') + '\n';
+
+  it('parseManyAsync()', (done) => {
+    JSONAsync.parseManyAsync('{"a":1}\n\n  [1, 2]\r\n"string"')
+      .then((documents) => {
+        assert.deepEqual(documents.map((d) => d.toObject()), [{ a: 1 }, [1, 2], 'string']);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('parseManyAsync() rejects invalid lines', (done) => {
+    JSONAsync.parseManyAsync('{"a":1}\n{"a":\n')
+      .then(() => done(new Error('should have rejected')))
+      .catch((e) => {
+        assert.match(e.message, /line 2/);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('parseManyParallel()', async () => {
+    const result: any[] = [];
+    for await (const document of JSONAsync.parseManyParallel(Buffer.from(lines), { threads: 3 })) {
+      result.push(document.toObject());
+    }
+    assert.strictEqual(result.length, expected.length);
+    assert.deepEqual(result, expected);
+  });
+
+  it('parseManyParallel() rejects invalid lines in a later chunk', async () => {
+    const many = Array(300000).fill('{"a":1}');
+    many[250000] = '{"a":';
+    let count = 0;
+    try {
+      for await (const document of JSONAsync.parseManyParallel(many.join('\n'), { threads: 4 })) {
+        assert.deepEqual(document.toObject(), { a: 1 });
+        count++;
+      }
+      assert.fail('should have thrown');
+    } catch (e) {
+      assert.match((e as Error).message, /^line 250001: /);
+    }
+    assert.isAtMost(count, 250000);
+  });
+
+  it('parseManyParallel() with an early exit', async () => {
+    let count = 0;
+    for await (const document of JSONAsync.parseManyParallel(lines)) {
+      assert.deepEqual(document.toObject(), expected[count]);
+      if (++count == 10) break;
+    }
+    assert.strictEqual(count, 10);
+  });
+});
@@ -0,0 +1,88 @@
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('dedicated thread pool', function () {
+  this.timeout(10000);
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'canada.json'), 'utf8');
+  const expected = JSON.parse(text);
+
+  afterEach(() => {
+    JSONAsync.threads = 0;
+  });
+
+  it('JSON.threads', () => {
+    assert.strictEqual(JSONAsync.threads, 0);
+    JSONAsync.threads = 2;
+    assert.strictEqual(JSONAsync.threads, 2);
+    assert.throws(() => {
+      JSONAsync.threads = -1;
+    }, /Invalid value/);
+    // Limited to the number of cores
+    JSONAsync.threads = 2 ** 31 - 1;
+    assert.isAtMost(JSONAsync.threads, os.cpus().length);
+  });
+
+  it('parse family on the dedicated pool', (done) => {
+    JSONAsync.threads = 2;
+    Promise.all([
+      JSONAsync.parseAsync(text),
+      JSONAsync.parseManyAsync('{"a":1}\n{"b":2}'),
+      JSONAsync.parseAsyncBatch(['[1]', '[2]'], { threads: 2 })
+    ])
+      .then(([document, many, batch]) => {
+        assert.deepEqual(document.toObject(), expected);
+        assert.deepEqual(many.map((d) => d.toObject()), [{ a: 1 }, { b: 2 }]);
+        assert.deepEqual(batch.map((d) => (d as JSONAsync).toObject()), [[1], [2]]);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('jobs are ordered by priority', (done) => {
+    JSONAsync.threads = 1;
+    const order: string[] = [];
+    // The first job occupies the only thread while the others are queued
+    const q = [
+      JSONAsync.parseAsync(text).then(() => order.push('first')),
+      JSONAsync.parseAsync(text, { priority: -1 }).then(() => order.push('low')),
+      JSONAsync.parseAsync(text).then(() => order.push('normal')),
+      JSONAsync.parseAsync(text, { priority: 10 }).then(() => order.push('high'))
+    ];
+    Promise.all(q)
+      .then(() => {
+        assert.deepEqual(order, ['first', 'high', 'normal', 'low']);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('shrinking and growing', (done) => {
+    // The exited threads are joined and replaced
+    for (let i = 0; i < 10; i++) {
+      JSONAsync.threads = 4;
+      JSONAsync.threads = 1;
+    }
+    JSONAsync.threads = 2;
+    Promise.all([JSONAsync.parseAsync(text), JSONAsync.parseAsync(text)])
+      .then((documents) => {
+        for (const document of documents) assert.deepEqual(document.toObject(), expected);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('errors are delivered', (done) => {
+    JSONAsync.threads = 1;
+    JSONAsync.parseAsync('invalid JSON')
+      .then(() => done(new Error('did not throw')))
+      .catch((e) => {
+        assert.match(e.message, /TAPE_ERROR/);
+        done();
+      })
+      .catch(done);
+  });
+});
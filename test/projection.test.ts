@@ -0,0 +1,126 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('projections', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8');
+  const expected = JSON.parse(text);
+  const document = JSONAsync.parse(text);
+
+  const picked = {
+    statuses: expected.statuses.map((s: any) => ({ id: s.id })),
+    search_metadata: expected.search_metadata
+  };
+  const omitted = JSON.parse(text);
+  for (const s of omitted.statuses) {
+    delete s.entities;
+    delete s.user;
+  }
+  const both = {
+    statuses: expected.statuses.map((s: any) => {
+      const user = { ...s.user };
+      delete user.entities;
+      return { user };
+    })
+  };
+  const cases = [
+    { name: 'pick', opts: { pick: ['/search_metadata', '/statuses/*/id'] }, result: picked },
+    { name: 'omit', opts: { omit: ['/statuses/*/entities', '/statuses/*/user'] }, result: omitted },
+    { name: 'pick and omit', opts: { pick: ['/statuses/*/user'], omit: ['/statuses/*/user/entities'] }, result: both }
+  ];
+
+  for (const c of cases) {
+    it(`toObject() ${c.name}`, () => {
+      assert.deepEqual(document.toObject(c.opts), c.result);
+    });
+
+    it(`toObjectAsync() ${c.name}`, async () => {
+      assert.deepEqual(await document.toObjectAsync(c.opts), c.result);
+    });
+
+    it(`toObjectAsync() ${c.name} in small slices`, async () => {
+      const sliceNodes = JSONAsync.sliceNodes;
+      JSONAsync.sliceNodes = 7;
+      try {
+        assert.deepEqual(await document.toObjectAsync(c.opts), c.result);
+      } finally {
+        JSONAsync.sliceNodes = sliceNodes;
+      }
+    });
+
+    it(`toObjectAsync() ${c.name} with offload`, async () => {
+      assert.deepEqual(await document.toObjectAsync({ ...c.opts, offload: true }), c.result);
+    });
+
+    it(`toObjectAsync() ${c.name} rejects v8`, () => {
+      assert.throws(() => document.toObjectAsync({ ...c.opts, v8: true } as any), TypeError, /v8/);
+    });
+  }
+
+  it('indices and escaped keys', () => {
+    const small = JSONAsync.parse('{"a/b": [10, 11, 12], "m~n": 2, "c": 3}');
+    assert.deepEqual(small.toObject({ pick: ['/a~1b/1', '/m~0n'] }), { 'a/b': [11], 'm~n': 2 });
+    assert.deepEqual(small.toObject({ omit: ['/a~1b/0', '/c'] }), { 'a/b': [11, 12], 'm~n': 2 });
+    assert.deepEqual(small.toObject({ pick: [''] }), small.toObject());
+  });
+
+  it('arrays are compacted', async () => {
+    const small = JSONAsync.parse('[1, {"a": 1, "b": 2}, [3], {"b": 4}, "a"]');
+    const result = [{ a: 1 }, [], {}];
+    assert.deepEqual(small.toObject({ pick: ['/*/a'] }), result);
+    assert.deepEqual(await small.toObjectAsync({ pick: ['/*/a'] }), result);
+    assert.deepEqual(await small.toObjectAsync({ pick: ['/*/a'], offload: true }), result);
+    assert.deepEqual(small.toObject({ omit: ['/1', '/3'] }), [1, [3], 'a']);
+    assert.deepEqual(await small.toObjectAsync({ omit: ['/1', '/3'] }), [1, [3], 'a']);
+  });
+
+  it('invalid projections', () => {
+    assert.throws(() => document.toObject({ omit: [''] }), /root/);
+    assert.throws(() => document.toObject({ pick: ['statuses'] }));
+    assert.throws(() => document.toObject({ pick: '/statuses' as any }), /array/);
+    assert.throws(() => document.toObjectAsync({ pick: [1] as any }), /array/);
+  });
+});
+
+describe('parse({ only })', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8');
+  const expected = JSON.parse(text);
+  const only = ['/search_metadata', '/statuses/*/id', '/statuses/*/user/screen_name'];
+  const result = {
+    statuses: expected.statuses.map((s: any) => ({ id: s.id, user: { screen_name: s.user.screen_name } })),
+    search_metadata: expected.search_metadata
+  };
+
+  it('parse()', () => {
+    const document = JSONAsync.parse(text, { only });
+    assert.deepEqual(document.toObject(), result);
+    assert.isBelow(document.stringify().length, text.length / 10);
+  });
+
+  it('parseAsync()', async () => {
+    const document = await JSONAsync.parseAsync(Buffer.from(text), { only });
+    assert.deepEqual(document.toObject(), result);
+  });
+
+  it('escaped keys and scalars', () => {
+    assert.deepEqual(JSONAsync.parse('{"a\\u0062": [1, 2, 3], "c": 4}', { only: ['/ab/1'] }).toObject(), { ab: [2] });
+    assert.deepEqual(JSONAsync.parse('[{"a": 1}, 2, {"b": 3}]', { only: ['/*/a'] }).toObject(), [{ a: 1 }, {}]);
+    assert.strictEqual(JSONAsync.parse('42', { only: ['/a'] }).toObject(), 42);
+    assert.deepEqual(JSONAsync.parse('{"a": 1}', { only: [] }).toObject(), { a: 1 });
+  });
+
+  it('invalid input', async () => {
+    assert.throws(() => JSONAsync.parse('{"a": [1, 2}', { only: ['/a'] }));
+    assert.throws(() => JSONAsync.parse('{"a": 1}', { only: ['a'] }));
+    assert.throws(() => JSONAsync.parse('{"a": 1}', { only: '/a' as any }), /array/);
+    try {
+      await JSONAsync.parseAsync('{"a": [1, 2}', { only: ['/a'] });
+    } catch (e) {
+      assert.instanceOf(e, Error);
+      return;
+    }
+    assert.fail('did not throw');
+  });
+});
@@ -20,6 +20,39 @@ describe('proxify()', () => {
       (expected.features[0].geometry as Polygon).coordinates[10]);
   });
 
+  it('cached proxies', () => {
+    const document = JSONAsync.parse<FeatureCollection>(text).proxify();
+    assert.strictEqual(document.features, document.features);
+    assert.strictEqual(document.features[0], document.features[0]);
+    const raw = JSONAsync.parse(text);
+    assert.strictEqual(raw.proxify(), raw.proxify());
+  });
+
+  it('missing properties and array length', () => {
+    const document = JSONAsync.parse<FeatureCollection>(text).proxify();
+    assert.isUndefined((document as any).invalid);
+    assert.isUndefined((document.features as any).invalid);
+    assert.strictEqual(document.features.length, expected.features.length);
+    assert.isUndefined(document.features[expected.features.length]);
+  });
+
+  it('property existence', () => {
+    const document = JSONAsync.parse<FeatureCollection>(text).proxify();
+    assert.isTrue('features' in document);
+    assert.isFalse('invalid' in document);
+    assert.isTrue(0 in document.features);
+    assert.isTrue('length' in document.features);
+    assert.isFalse(expected.features.length in document.features);
+    assert.isUndefined(Object.getOwnPropertyDescriptor(document, 'invalid'));
+    assert.isTrue(Object.getOwnPropertyDescriptor(document, 'features')?.enumerable);
+  });
+
+  it('the proxy helpers are not part of the API', () => {
+    assert.notProperty(JSONAsync.prototype, 'proxyGet');
+    assert.notProperty(JSONAsync.prototype, 'proxyHas');
+    assert.notProperty(JSONAsync, 'proxyHandler');
+  });
+
   it('parseAsync()', (done) => {
     JSONAsync.parseAsync<FeatureCollection>(text)
       .then((raw) => {
@@ -0,0 +1,61 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('query()', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8');
+  const expected = JSON.parse(text);
+  const names: string[] = expected.statuses.map((s: any) => s.user.screen_name);
+
+  it('query()', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.query('/statuses/*/user/screen_name');
+    assert.isArray(result);
+    assert.deepEqual(result.map((el) => el.get()), names);
+    assert.strictEqual(result[0], document.path('/statuses/0/user/screen_name'));
+  });
+
+  it('query() skips missing elements', () => {
+    const document = JSONAsync.parse(JSON.stringify({ a: [{ n: 1 }, { m: 2 }, { n: 3 }] }));
+    assert.deepEqual(document.query('/a/*/n').map((el) => el.get()), [1, 3]);
+    assert.throws(() => document.query('/b/*'));
+  });
+
+  it('queryAsync()', (done) => {
+    const document = JSONAsync.parse(text);
+    document.queryAsync('/statuses/*/user/screen_name')
+      .then((result) => {
+        assert.deepEqual(result.map((el) => el.get()), names);
+        assert.strictEqual(result[1], document.path('/statuses/1/user/screen_name'));
+        done();
+      })
+      .catch(done);
+  });
+
+  it('pathAsync()', (done) => {
+    const document = JSONAsync.parse(text);
+    document.pathAsync('/statuses/3/user')
+      .then((user) => {
+        assert.deepEqual(user.toObject(), expected.statuses[3].user);
+        assert.strictEqual(user, document.path('/statuses/3/user'));
+        return document.pathAsync('/statuses/3/invalid', { throwOnError: false });
+      })
+      .then((missing) => {
+        assert.isUndefined(missing);
+        // An empty options object keeps the default, the same as path()
+        assert.throws(() => document.path('/statuses/3/invalid', {}), /field/i);
+        return document.pathAsync('/statuses/3/invalid', {});
+      })
+      .then(() => done(new Error('should have rejected')))
+      .catch((e) => {
+        try {
+          assert.match(e.message, /field/i);
+          done();
+        } catch (err) {
+          done(err);
+        }
+      });
+  });
+});
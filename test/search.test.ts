@@ -0,0 +1,69 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+// Reference implementation
+function search(value: any, needle: string, keys: boolean, values: boolean, path = ''): string[] {
+  const r: string[] = [];
+  if (typeof value === 'string') {
+    if (values && value.includes(needle)) r.push(path);
+  } else if (Array.isArray(value)) {
+    value.forEach((v, i) => r.push(...search(v, needle, keys, values, `${path}/${i}`)));
+  } else if (value && typeof value === 'object') {
+    for (const key of Object.keys(value)) {
+      const sub = `${path}/${key.replace(/~/g, '~0').replace(/\//g, '~1')}`;
+      if (keys && key.includes(needle)) r.push(sub);
+      const children = search(value[key], needle, keys, values, sub);
+      if (children[0] === sub && r[r.length - 1] === sub) children.shift();
+      r.push(...children);
+    }
+  }
+  return r;
+}
+
+describe('search()', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8');
+  const expected = JSON.parse(text);
+
+  it('keys and values', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.search('http');
+    assert.isAbove(result.length, 0);
+    assert.deepEqual(result, search(expected, 'http', true, true));
+  });
+
+  it('values only', () => {
+    const document = JSONAsync.parse(text);
+    assert.deepEqual(document.search('url', { keys: false }), search(expected, 'url', false, true));
+  });
+
+  it('keys only', () => {
+    const document = JSONAsync.parse(text);
+    assert.deepEqual(document.search('url', { values: false }), search(expected, 'url', true, false));
+  });
+
+  it('subtree', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.path('/statuses/10').search('a');
+    assert.deepEqual(result, search(expected.statuses[10], 'a', true, true));
+    for (const p of result.slice(0, 10))
+      assert.instanceOf(document.path('/statuses/10').path(p), JSONAsync);
+  });
+
+  it('subtree bounds', () => {
+    const document = JSONAsync.parse(JSON.stringify({ a: ['needle'], b: { c: [1, 2] }, d: 'needle', e: { needle: true } }));
+    assert.deepEqual(document.path('/b').search('needle'), []);
+    assert.deepEqual(document.path('/b/c/0').search('needle'), []);
+    assert.deepEqual(document.path('/d').search('needle'), ['']);
+    assert.deepEqual(document.path('/e').search('needle'), ['/needle']);
+    assert.deepEqual(document.path('/e').search('needle', { keys: false }), []);
+  });
+
+  it('escaping', () => {
+    const document = JSONAsync.parse(JSON.stringify({ 'a/b': { 'c~d': 'needle' }, e: ['no', 'needles'] }));
+    assert.deepEqual(document.search('needle'), ['/a~1b/c~0d', '/e/1']);
+    assert.deepEqual(document.search('absent'), []);
+  });
+});
@@ -0,0 +1,108 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import * as v8 from 'v8';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('serialization', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8');
+  const expected = JSON.parse(text);
+
+  it('stringify()', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.stringify();
+    assert.isString(result);
+    assert.notInclude(result, '\n');
+    assert.deepEqual(JSON.parse(result), expected);
+    assert.deepEqual(JSON.parse(document.path('/statuses/3/user').stringify()), expected.statuses[3].user);
+    assert.strictEqual(document.path('/statuses/3/user/screen_name').stringify(),
+      JSON.stringify(expected.statuses[3].user.screen_name));
+  });
+
+  it('toBuffer()', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.path('/statuses').toBuffer();
+    assert.instanceOf(result, Buffer);
+    assert.deepEqual(JSON.parse(result.toString('utf8')), expected.statuses);
+  });
+
+  it('stringifyAsync()', (done) => {
+    JSONAsync.parseAsync(text)
+      .then((document) => document.path('/statuses/0').stringifyAsync())
+      .then((result) => {
+        assert.isString(result);
+        assert.deepEqual(JSON.parse(result), expected.statuses[0]);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('toBufferAsync()', (done) => {
+    JSONAsync.parseAsync(text)
+      .then((document) => document.toBufferAsync())
+      .then((result) => {
+        assert.instanceOf(result, Buffer);
+        assert.deepEqual(JSON.parse(result.toString('utf8')), expected);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('toV8Buffer()', () => {
+    const document = JSONAsync.parse(text);
+    const result = document.toV8Buffer();
+    assert.instanceOf(result, Buffer);
+    assert.deepEqual(v8.deserialize(result), expected);
+
+    const special = '{"a":[1,2.5,-3,4294967296,true,false,null,{},[]],"é":"àé","b":"€😀","dup":1,"x":0,"dup":2}';
+    assert.deepEqual(v8.deserialize(JSONAsync.parse(special).toV8Buffer()), JSON.parse(special));
+    assert.deepEqual(Object.keys(v8.deserialize(JSONAsync.parse(special).toV8Buffer())),
+      Object.keys(JSON.parse(special)));
+  });
+
+  it('toV8BufferAsync()', (done) => {
+    JSONAsync.parseAsync(text)
+      .then((document) => document.path('/statuses/1').toV8BufferAsync())
+      .then((result) => {
+        assert.instanceOf(result, Buffer);
+        assert.deepEqual(v8.deserialize(result), expected.statuses[1]);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('toObjectAsync({ v8: true })', (done) => {
+    JSONAsync.parseAsync(text)
+      .then((document) => document.toObjectAsync({ v8: true }))
+      .then((result) => {
+        assert.deepEqual(result, expected);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('toObjectAsync({ v8: true }) with time slicing options', () => {
+    const document = JSONAsync.parse(text);
+    assert.throws(() => document.toObjectAsync({ v8: true, latency: 10 }), TypeError, /latency/);
+    assert.throws(() => document.toObjectAsync({ v8: true, priority: 1 }), TypeError, /priority/);
+    assert.throws(() => document.toObjectAsync({ v8: true, offload: true }), TypeError, /offload/);
+  });
+
+  it('toObjectAsync({ v8: true, signal })', (done) => {
+    const document = JSONAsync.parse(text);
+    const controller = new AbortController();
+    const q = document.toObjectAsync({ v8: true, signal: controller.signal });
+    controller.abort(new Error('cancelled'));
+    q.then(() => done(new Error('did not reject')))
+      .catch((e) => {
+        assert.strictEqual(e.message, 'cancelled');
+        return document.toObjectAsync({ v8: true, signal: new AbortController().signal });
+      })
+      .then((result) => {
+        assert.deepEqual(result, expected);
+        done();
+      })
+      .catch(done);
+  });
+});
@@ -0,0 +1,57 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { assert } from 'chai';
+import Piscina from 'piscina';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('sharing between environments', function () {
+  this.timeout(10000);
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'citm_catalog.json'), 'utf8');
+  const expected = JSON.parse(text);
+
+  it('share() / open()', () => {
+    const document = JSONAsync.parse(text);
+    const token = document.share();
+    assert.match(token, /^everything-json:[0-9a-f]{32}$/);
+    assert.strictEqual(document.share(), token);
+    assert.notStrictEqual(JSONAsync.parse(text).share(), token);
+    const opened = JSONAsync.open(token);
+    assert.notStrictEqual(opened, document);
+    assert.deepEqual(opened.toObject(), expected);
+  });
+
+  it('shared subtrees', () => {
+    const document = JSONAsync.parse(text);
+    const performances = document.path('/performances');
+    assert.deepEqual(JSONAsync.open(performances.share()).toObject(), expected.performances);
+  });
+
+  it('rejects invalid tokens', () => {
+    assert.throws(() => JSONAsync.open('everything-json:0'), /Invalid token/);
+    assert.throws(() => JSONAsync.open('invalid'), /Invalid token/);
+  });
+
+  it('open() in worker_threads', (done) => {
+    const piscina = new Piscina({ filename: path.resolve(__dirname, 'share.worker.mjs') });
+    const document = JSONAsync.parse(text);
+    const token = document.share();
+
+    const q: Promise<void>[] = [];
+    for (let i = 0; i < 4; i++) {
+      const pointer = `/performances/${i}`;
+      q.push(piscina.run({ token, pointer }).then((r: any) => {
+        assert.deepEqual(r, expected.performances[i]);
+      }));
+    }
+
+    Promise.all(q)
+      .then(() => {
+        // The token remains valid as long as document is alive
+        assert.isObject(document.get());
+        return piscina.destroy();
+      })
+      .then(() => done())
+      .catch(done);
+  });
+});
@@ -0,0 +1,6 @@
+import { JSON as JSONAsync } from 'everything-json';
+
+export default function ({ token, pointer }) {
+  const json = JSONAsync.open(token);
+  return json.path(pointer).toObject();
+}
@@ -0,0 +1,60 @@
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('snapshots', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'citm_catalog.json'), 'utf8');
+  const expected = JSON.parse(text);
+  const file = path.resolve(os.tmpdir(), `everything-json-${process.pid}.snapshot`);
+
+  afterEach(() => {
+    if (fs.existsSync(file)) fs.unlinkSync(file);
+  });
+
+  it('save() / load()', () => {
+    JSONAsync.parse(text).save(file);
+    const document = JSONAsync.load(file);
+    assert.deepEqual(document.toObject(), expected);
+    assert.deepEqual(document.path('/performances/0').toObject(), expected.performances[0]);
+    assert.deepEqual(JSONAsync.load(file, { validate: true }).toObject(), expected);
+  });
+
+  it('save() from a nested element saves the whole document', () => {
+    JSONAsync.parse(text).path('/performances').save(file);
+    assert.deepEqual(JSONAsync.load(file).toObject(), expected);
+  });
+
+  it('primitive documents', () => {
+    JSONAsync.parse('"string"').save(file);
+    assert.strictEqual(JSONAsync.load(file).get(), 'string');
+    JSONAsync.parse('42').save(file);
+    assert.strictEqual(JSONAsync.load(file).get(), 42);
+  });
+
+  it('rejects invalid files', () => {
+    assert.throws(() => JSONAsync.load(path.resolve(__dirname, 'data', 'citm_catalog.json')), /not a snapshot/);
+    assert.throws(() => JSONAsync.load(file), /Failed opening/);
+  });
+
+  it('rejects corrupted files', () => {
+    JSONAsync.parse(text).save(file);
+    const data = fs.readFileSync(file);
+    // Overwrite the first tape word after the root with an array
+    // pointing to the wrong position (little-endian)
+    data.writeUInt32LE(0x000000ff, 64 + 8);
+    data.writeUInt32LE(0x5b000000, 64 + 12);
+    fs.writeFileSync(file, data);
+    assert.throws(() => JSONAsync.load(file, { validate: true }), /Corrupted/);
+  });
+
+  it('rejects truncated files', () => {
+    JSONAsync.parse(text).save(file);
+    const data = fs.readFileSync(file);
+    // Without the padding after the string buffer
+    fs.writeFileSync(file, data.subarray(0, data.length - 1));
+    assert.throws(() => JSONAsync.load(file), /Corrupted/);
+  });
+});
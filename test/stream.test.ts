@@ -0,0 +1,74 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import * as zlib from 'zlib';
+import { assert } from 'chai';
+import type { FeatureCollection, Feature } from 'geojson';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+const jsonText = zlib.unzipSync(fs.readFileSync(path.resolve(__dirname, 'data', 'sf_citylots.json.gz')));
+
+describe('toObjectStream()', function () {
+  this.timeout(100000);
+  let document: JSONAsync<FeatureCollection>;
+  let expected: FeatureCollection;
+
+  before((done) => {
+    expected = JSON.parse(jsonText.toString());
+    JSONAsync.parseAsync<FeatureCollection>(jsonText)
+      .then((r) => {
+        document = r;
+        done();
+      })
+      .catch(done);
+  });
+
+  it('yields all elements in chunks', async () => {
+    const features: Feature[] = [];
+    let chunks = 0;
+    for await (const chunk of document.get().features.toObjectStream({ chunkSize: 10000 })) {
+      assert.isAtMost(chunk.length, 10000);
+      features.push(...chunk);
+      chunks++;
+    }
+    assert.strictEqual(chunks, Math.ceil(expected.features.length / 10000));
+    assert.deepEqual(features, expected.features);
+  });
+
+  it('small arrays', async () => {
+    const small = JSONAsync.parse<number[][]>('[[1], [2, 3], [], {"a": 4}]');
+    const chunks: unknown[] = [];
+    for await (const chunk of small.toObjectStream({ chunkSize: 3 })) {
+      chunks.push(chunk);
+    }
+    assert.deepEqual(chunks, [[[1], [2, 3], []], [{ a: 4 }]]);
+
+    const empty = JSONAsync.parse<number[]>('[]');
+    for await (const chunk of empty.toObjectStream()) {
+      assert.fail(`unexpected chunk ${chunk}`);
+    }
+  });
+
+  it('the consumer can stop', async () => {
+    let chunks = 0;
+    for await (const chunk of document.get().features.toObjectStream({ chunkSize: 100 })) {
+      assert.lengthOf(chunk, 100);
+      if (++chunks == 3) break;
+    }
+    assert.strictEqual(chunks, 3);
+  });
+
+  it('rejects non-arrays', async () => {
+    const object = JSONAsync.parse('{"a": 1}');
+    try {
+      // eslint-disable-next-line @typescript-eslint/no-unused-vars
+      for await (const chunk of object.toObjectStream()) {
+        assert.fail('did not throw');
+      }
+    } catch (e) {
+      assert.match((e as Error).message, /expects an array/);
+      return;
+    }
+    assert.fail('did not throw');
+  });
+});
@@ -0,0 +1,70 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { assert } from 'chai';
+
+import { JSON as JSONAsync } from 'everything-json';
+
+describe('JSON.stringify()', () => {
+  const text = fs.readFileSync(path.resolve(__dirname, 'data', 'twitter.json'), 'utf8');
+  const twitter = JSON.parse(text);
+
+  const values: Record<string, any> = {
+    'nested objects': twitter,
+    'arrays with holes': [1, undefined, () => 0, Symbol('s'), null, , 3],
+    'skipped properties': { a: undefined, b: () => 0, c: 1, [Symbol('s')]: 2 },
+    'toJSON()': { date: new Date(0), custom: { toJSON: (key: string) => `key=${key}` } },
+    'toJSON() in arrays': [0, { toJSON: (key: string) => `key=${key}` }, new Date(0)],
+    'boxed primitives': { n: new Number(1.5), s: new String('a"b'), b: new Boolean(false), a: [new Number(-0)] },
+    'lone surrogates': ['\ud800', 'a\udc00b', '\ud83d\ude00\ud83d', { '\udfff': '\ufffd' }],
+    numbers: [0, -0, 1, -42, 0.1, 1e21, 1e-7, 123.456, 2 ** 53, 5e-324, NaN, Infinity, -Infinity, 1 / 3,
+      1234567890123456789, 1.7976931348623157e308, 2.2250738585072014e-308, 4.35, 0.3, 5e-7, 1e15 + 0.5],
+    strings: ['', 'ascii', 'a"b\\c', '\n\r\t\b\f\u0001\u001f', 'ünicode 🌍', 'a long string without any escapes'],
+    'numeric keys': { 2: 'b', 1: 'a', x: 'c' },
+    primitives: [true, false, null, 'string', 42]
+  };
+
+  for (const name of Object.keys(values)) {
+    it(name, () => {
+      assert.strictEqual(JSONAsync.stringify(values[name]), JSON.stringify(values[name]));
+    });
+  }
+
+  it('top-level undefined', () => {
+    assert.isUndefined(JSONAsync.stringify(undefined));
+    assert.isUndefined(JSONAsync.stringify(() => 0));
+  });
+
+  it('embedded JSON elements', () => {
+    const document = JSONAsync.parse(text);
+    const value = { user: document.path('/statuses/0/user'), count: 1 };
+    assert.strictEqual(JSONAsync.stringify(value),
+      JSON.stringify({ user: twitter.statuses[0].user, count: 1 }));
+  });
+
+  it('proxify() proxies', () => {
+    const document = JSONAsync.parse(text);
+    const value = { statuses: document.proxify().statuses, user: document.path('/statuses/0/user').proxify() };
+    assert.strictEqual(JSONAsync.stringify(value),
+      JSON.stringify({ statuses: twitter.statuses, user: twitter.statuses[0].user }));
+    assert.strictEqual(JSONAsync.stringify(document.proxify()), JSON.stringify(twitter));
+  });
+
+  it('circular structures', () => {
+    const value: any = { a: [] };
+    value.a.push(value);
+    assert.throws(() => JSONAsync.stringify(value), /circular/);
+  });
+
+  it('BigInt', () => {
+    assert.throws(() => JSONAsync.stringify({ a: eval('1n') }), /BigInt/);
+  });
+
+  it('stringifyAsync()', (done) => {
+    JSONAsync.stringifyAsync(twitter)
+      .then((result) => {
+        assert.strictEqual(result, JSON.stringify(twitter));
+        done();
+      })
+      .catch(done);
+  });
+});